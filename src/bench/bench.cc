@@ -0,0 +1,131 @@
+#include "bench/bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+BenchConfig ParseCommandLine(const int argc, const char *const *argv) {
+  BenchConfig config;
+
+  po::options_description options("Options");
+  options.add_options()("help,h", po::bool_switch(&config.help),
+                        "print help message")(
+      "list,l", po::bool_switch(&config.list), "list benchmarks and exit")(
+      "filter,f", po::value<std::string>(&config.filter),
+      "run benchmarks with the substring in name")(
+      "format", po::value<std::string>(&config.format)->default_value(config.format),
+      "output format: json (one object per line), csv")(
+      "min_time", po::value<long>(&config.min_time_ms)->default_value(config.min_time_ms),
+      "min duration of a single run, ms")(
+      "repeat", po::value<uint16_t>(&config.repeat)->default_value(config.repeat),
+      "measured runs per benchmark");
+
+  po::variables_map vm;
+
+  try {
+    po::store(po::parse_command_line(argc, argv, options), vm);
+    po::notify(vm);
+  } catch (const po::error &e) {
+    std::cerr << "error: " << e.what() << '\n';
+    config.help = true;
+  }
+
+  if (config.format != "json" && config.format != "csv") {
+    std::cerr << "error: unknown format " << config.format << '\n';
+    config.help = true;
+  }
+
+  if (config.help) {
+    std::cerr << "Usage: slither_bench [OPTIONS]\n";
+    std::cerr << options << '\n';
+    exit(1);
+  }
+
+  config.repeat = std::max<uint16_t>(1, config.repeat);
+  return config;
+}
+
+BenchRunner::BenchRunner(BenchConfig in_config) : config(in_config) {}
+
+void BenchRunner::Add(const std::string &name, BenchFn fn) { entries.push_back(Entry{name, fn}); }
+
+int BenchRunner::Run(std::ostream &out) {
+  if (config.format == "csv") {
+    out << "name,iterations,runs,ns_per_op,min_ns_per_op,max_ns_per_op\n";
+  }
+
+  for (const Entry &e : entries) {
+    if (!config.filter.empty() && e.name.find(config.filter) == std::string::npos) {
+      continue;
+    }
+
+    if (config.list) {
+      out << e.name << '\n';
+      continue;
+    }
+
+    Print(out, Measure(e.name, e.fn));
+  }
+
+  return 0;
+}
+
+BenchResult BenchRunner::Measure(const std::string &name, const BenchFn &fn) {
+  using std::chrono::steady_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  const auto run = [&fn](size_t n) -> double {
+    const auto start = steady_clock::now();
+    fn(n);
+    return 1.0 * duration_cast<nanoseconds>(steady_clock::now() - start).count();
+  };
+
+  // calibrate, also warms up caches and allocations
+  const double min_time_ns = config.min_time_ms * 1e6;
+  size_t n = 1;
+  for (;;) {
+    const double t = run(n);
+    if (t >= min_time_ns) {
+      break;
+    }
+    // aim a bit over the target, at most 10x per step
+    const double scale = t > 0.0 ? std::min(10.0, 1.2 * min_time_ns / t) : 10.0;
+    n = std::max(n + 1, static_cast<size_t>(n * scale));
+  }
+
+  std::vector<double> samples;
+  for (uint16_t i = 0; i < config.repeat; i++) {
+    samples.push_back(run(n) / n);
+  }
+  std::sort(samples.begin(), samples.end());
+
+  BenchResult r;
+  r.name = name;
+  r.iterations = n;
+  r.runs = config.repeat;
+  r.ns_per_op = samples[samples.size() / 2];
+  r.min_ns_per_op = samples.front();
+  r.max_ns_per_op = samples.back();
+  return r;
+}
+
+void BenchRunner::Print(std::ostream &out, const BenchResult &r) {
+  out << std::fixed << std::setprecision(2);
+
+  if (config.format == "csv") {
+    out << r.name << ',' << r.iterations << ',' << r.runs << ',' << r.ns_per_op << ','
+        << r.min_ns_per_op << ',' << r.max_ns_per_op << '\n';
+  } else {
+    out << "{\"name\":\"" << r.name << "\",\"iterations\":" << r.iterations << ",\"runs\":" << r.runs
+        << ",\"ns_per_op\":" << r.ns_per_op << ",\"min_ns_per_op\":" << r.min_ns_per_op
+        << ",\"max_ns_per_op\":" << r.max_ns_per_op << "}\n";
+  }
+
+  out.flush();
+}
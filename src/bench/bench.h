@@ -0,0 +1,70 @@
+#ifndef SRC_BENCH_BENCH_H_
+#define SRC_BENCH_BENCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Keeps the compiler from optimizing out a computed value.
+template <typename T>
+inline void DoNotOptimize(const T &v) {
+  asm volatile("" : : "g"(&v) : "memory");
+}
+
+struct BenchConfig {
+  std::string filter;           // run only benchmarks with the substring in name
+  std::string format = "json";  // json - one object per line, csv
+  long min_time_ms = 50;        // minimal duration of a single measured run
+  uint16_t repeat = 5;          // measured runs, median is reported
+
+  bool list = false;
+  bool help = false;
+};
+
+BenchConfig ParseCommandLine(const int argc, const char *const *argv);
+
+struct BenchResult {
+  std::string name;
+  uint64_t iterations = 0;  // per run
+  uint16_t runs = 0;
+  double ns_per_op = 0.0;  // median of runs
+  double min_ns_per_op = 0.0;
+  double max_ns_per_op = 0.0;
+};
+
+// Benchmark body, runs the measured operation n times. State is prepared
+// by the registering code and captured by the closure.
+typedef std::function<void(size_t n)> BenchFn;
+
+// Minimal benchmark runner. Iteration count is calibrated until a single run
+// takes at least min_time_ms, then the runs are repeated and ns per op
+// statistics are printed in a machine readable format.
+class BenchRunner {
+ public:
+  explicit BenchRunner(BenchConfig in_config);
+
+  void Add(const std::string &name, BenchFn fn);
+  int Run(std::ostream &out);  // NOLINT(runtime/references)
+
+ private:
+  BenchResult Measure(const std::string &name, const BenchFn &fn);
+  void Print(std::ostream &out, const BenchResult &r);  // NOLINT(runtime/references)
+
+ private:
+  struct Entry {
+    std::string name;
+    BenchFn fn;
+  };
+
+  BenchConfig config;
+  std::vector<Entry> entries;
+};
+
+void RegisterGameBenchmarks(BenchRunner *r);
+void RegisterPacketBenchmarks(BenchRunner *r);
+void RegisterTlsBenchmarks(BenchRunner *r);
+
+#endif  // SRC_BENCH_BENCH_H_
@@ -0,0 +1,443 @@
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+#include "game/math.h"
+#include "game/random.h"
+#include "game/world.h"
+
+// world with no food and no bots, so snakes keep their length
+static std::shared_ptr<World> NewEmptyWorld(uint16_t snake_len) {
+  WorldConfig config;
+  config.bots = 0;
+  config.snake_min_length = static_cast<uint16_t>(snake_len - 3);
+  config.snake_average_length = 1;
+
+  auto world = std::make_shared<World>();
+  world->Init(config);
+  for (Sector &s : world->GetSectors()) {
+    s.food.clear();
+  }
+
+  return world;
+}
+
+static Snake *NewSnake(World *world) {
+  Snake::Ptr s = world->CreateSnake(true);
+  world->AddSnake(s);
+  return s.get();
+}
+
+// keeps the snake circling in place
+static void Turn(Snake *s) {
+  s->state->wangle = Math::normalize_angle(s->state->angle + 1.0f);
+  s->state->update = 0;
+  s->eaten.clear();
+}
+
+static void RegisterSnakeBenchmarks(BenchRunner *r) {
+  static const uint16_t lengths[] = {10, 50, 200, 400};
+  static const long step_ms =
+      static_cast<long>(1000 * WorldConfig::move_step_distance / Snake::base_move_speed) + 1;
+
+  for (uint16_t len : lengths) {
+    const std::string suffix = "/len=" + std::to_string(len);
+
+    {
+      auto world = NewEmptyWorld(len);
+      Snake *s = NewSnake(world.get());
+      r->Add("snake_tick" + suffix, [world, s](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+          Turn(s);
+          DoNotOptimize(s->Tick(WorldConfig::frame_time_ms, &world->GetSectors(), false));
+        }
+      });
+    }
+
+    {
+      // every tick makes a movement step
+      auto world = NewEmptyWorld(len);
+      Snake *s = NewSnake(world.get());
+      r->Add("snake_tick_step" + suffix, [world, s](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+          Turn(s);
+          DoNotOptimize(s->Tick(step_ms, &world->GetSectors(), false));
+        }
+      });
+    }
+
+    {
+      // probes along the tail: next to the body (full scan, miss) and on the
+      // last part (full scan, hit)
+      auto world = NewEmptyWorld(len);
+      Snake *s = NewSnake(world.get());
+      const Body &tail = s->parts.back();
+      const float r1 = s->get_snake_body_part_radius();
+      const float dx = s->get_head_x() - tail.x;
+      const float dy = s->get_head_y() - tail.y;
+      const float d = sqrtf(dx * dx + dy * dy);
+      const float off = 3.0f * r1 / d;
+
+      const BoundBoxPos miss((s->get_head_x() + tail.x) / 2.0f - dy * off,
+                             (s->get_head_y() + tail.y) / 2.0f + dx * off, r1);
+      const BoundBoxPos hit(tail.x, tail.y, r1);
+
+      r->Add("snake_intersect_miss" + suffix, [world, s, miss](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+          DoNotOptimize(s->Intersect(miss));
+        }
+      });
+
+      r->Add("snake_intersect_hit" + suffix, [world, s, hit](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+          DoNotOptimize(s->Intersect(hit));
+        }
+      });
+    }
+  }
+}
+
+static void RegisterWorldBenchmarks(BenchRunner *r) {
+  static const uint16_t counts[] = {100, 1000, 5000};
+
+  for (uint16_t count : counts) {
+    WorldConfig config;
+    config.bots = count;
+
+    auto world = std::make_shared<World>();
+    world->Init(config);
+
+    auto snakes = std::make_shared<SnakeVec>();
+    for (auto &pair : world->GetSnakes()) {
+      snakes->push_back(pair.second.get());
+    }
+
+    r->Add("world_check_snake_bounds/snakes=" + std::to_string(count), [world, snakes](size_t n) {
+      size_t k = 0;
+      for (size_t i = 0; i < n; i++) {
+        Snake *s = (*snakes)[k];
+        world->CheckSnakeBounds(s);
+        DoNotOptimize(s->state->update);
+        s->state->update = 0;
+
+        if (++k == snakes->size()) {
+          k = 0;
+        }
+      }
+    });
+  }
+
+  // crowded center: parallel lanes of short snakes around the middle of the
+  // map, close but not touching, so every check scans all the neighbours
+  static const uint16_t crowds[] = {16, 64, 256};
+  static const int lane_parts = 8;
+  static const int lane_columns = 4;
+  static const float lane_pitch_x = 240.0f;
+  static const float lane_pitch_y = 36.0f;
+
+  for (uint16_t count : crowds) {
+    auto world = NewEmptyWorld(3);
+    auto snakes = std::make_shared<SnakeVec>();
+
+    const int rows = (count + lane_columns - 1) / lane_columns;
+    const float left = WorldConfig::game_radius - lane_columns * lane_pitch_x / 2.0f;
+    const float top = WorldConfig::game_radius - rows * lane_pitch_y / 2.0f;
+
+    for (uint16_t i = 0; i < count; i++) {
+      auto s = std::make_shared<Snake>();
+      s->id = static_cast<snake_id_t>(1000 + i);
+      s->bot = true;
+      s->skin = 9;
+      s->state->speed = Snake::base_move_speed;
+      s->fullness = 0;
+      s->state->angle = 0.0f;
+      s->state->wangle = 0.0f;
+
+      // heads to the right, tails to the left
+      const float x = left + (i % lane_columns + 1) * lane_pitch_x;
+      const float y = top + (i / lane_columns) * lane_pitch_y;
+      for (int j = 0; j < lane_parts; j++) {
+        s->parts.push_back(Body{x - j * Snake::tail_step_distance, y});
+      }
+
+      world->PlaceSnake(s.get());
+      world->AddSnake(s);
+      snakes->push_back(s.get());
+    }
+
+    r->Add("world_check_snake_bounds_crowd/snakes=" + std::to_string(count), [world, snakes](size_t n) {
+      size_t k = 0;
+      for (size_t i = 0; i < n; i++) {
+        Snake *s = (*snakes)[k];
+        world->CheckSnakeBounds(s);
+        DoNotOptimize(s->state->update);
+        s->state->update = 0;
+
+        if (++k == snakes->size()) {
+          k = 0;
+        }
+      }
+    });
+  }
+}
+
+static void RegisterSectorBenchmarks(BenchRunner *r) {
+  static const size_t sizes[] = {10, 100, 1000};
+
+  for (size_t size : sizes) {
+    const std::string suffix = "/food=" + std::to_string(size);
+
+    // sector food lives in the arena of the sequence
+    auto ss = std::make_shared<SectorSeq>();
+    ss->InitSectors();
+    Sector *sector = ss->get_sector(10, 10);
+    auto xs = std::make_shared<std::vector<uint16_t>>();
+
+    std::mt19937 rng(size);
+    std::uniform_int_distribution<uint16_t> pos(10 * WorldConfig::sector_size, 11 * WorldConfig::sector_size - 1);
+    for (size_t i = 0; i < size; i++) {
+      sector->Insert(Food{pos(rng), pos(rng), 1, 0});
+    }
+    for (size_t i = 0; i < 1024; i++) {
+      xs->push_back(pos(rng));
+    }
+
+    r->Add("sector_insert_remove" + suffix, [ss, sector, xs](size_t n) {
+      for (size_t i = 0; i < n; i++) {
+        const uint16_t x = (*xs)[i & 1023];
+        sector->Insert(Food{x, x, 1, 0});
+        sector->Remove(sector->FindClosestFood(x));
+      }
+    });
+
+    r->Add("sector_find_closest_food" + suffix, [ss, sector, xs](size_t n) {
+      for (size_t i = 0; i < n; i++) {
+        DoNotOptimize(sector->FindClosestFood((*xs)[i & 1023]));
+      }
+    });
+  }
+
+  {
+    // food of the whole map, after the sectors gained and lost food for a
+    // while as they do under dying snakes
+    WorldConfig config;
+    config.bots = 0;
+    auto world = std::make_shared<World>();
+    world->Init(config);
+
+    SectorSeq &ss = world->GetSectors();
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<size_t> pick(0, ss.size() - 1);
+    for (size_t i = 0; i < 4 * ss.size(); i++) {
+      Sector &s = ss[pick(rng)];
+      for (int k = 0; k < 8; k++) {
+        s.Insert(Food{static_cast<Food::coord_t>(s.get_origin_x() + rng() % WorldConfig::sector_size),
+                      static_cast<Food::coord_t>(s.get_origin_y() + rng() % WorldConfig::sector_size), 5, 0});
+      }
+      Sector &e = ss[pick(rng)];
+      for (int k = 0; k < 8 && !e.food.empty(); k++) {
+        e.Remove(e.food.begin());
+      }
+    }
+    world->Tick(WorldConfig::frame_time_ms);
+
+    r->Add("world_food_scan", [world](size_t n) {
+      const FoodArena &arena = world->GetSectors().get_food_arena();
+      for (size_t i = 0; i < n; i++) {
+        const SectorFood *items = arena.get_items();
+        uint32_t total = 0;
+        for (const FoodArena::Run &run : arena.get_runs()) {
+          for (uint32_t k = run.offset; k < run.offset + run.count; k++) {
+            total += items[k].size;
+          }
+        }
+        DoNotOptimize(total);
+      }
+    });
+  }
+}
+
+static void RegisterBoundBoxBenchmarks(BenchRunner *r) {
+  static const float radii[] = {100.0f, 500.0f, 1500.0f};
+
+  for (float radius : radii) {
+    auto ss = std::make_shared<SectorSeq>();
+    ss->InitSectors();
+
+    const float cx = WorldConfig::game_radius;
+    const float cy = WorldConfig::game_radius;
+    auto bb = std::make_shared<SnakeBoundBox>(BoundBoxPos{cx, cy, radius}, 1, nullptr, SectorVec());
+
+    // box center walks a circle with move steps, as a snake does
+    r->Add("sbb_update_sectors/r=" + std::to_string(static_cast<int>(radius)), [ss, bb, cx, cy](size_t n) {
+      static const float path_r = 3000.0f;
+      static const float step = WorldConfig::move_step_distance / path_r;
+      static const size_t steps = static_cast<size_t>(Math::f_2pi / step);
+
+      for (size_t i = 0; i < n; i++) {
+        const float a = step * (i % steps);
+        const float nx = cx + path_r * cosf(a);
+        const float ny = cy + path_r * sinf(a);
+
+        bb->UpdateBoxNewSectors(ss.get(), bb->r, nx, ny, bb->x, bb->y);
+        bb->x = nx;
+        bb->y = ny;
+        bb->UpdateBoxOldSectors();
+      }
+    });
+  }
+
+  {
+    auto ss = std::make_shared<SectorSeq>();
+    ss->InitSectors();
+    auto vp = std::make_shared<ViewPort>();
+
+    // player head walks a circle with move steps, the sender collects the
+    // sectors to add and remove every step
+    r->Add("viewport_update", [ss, vp](size_t n) {
+      static const float path_r = 3000.0f;
+      static const float step = WorldConfig::move_step_distance / path_r;
+      static const size_t steps = static_cast<size_t>(Math::f_2pi / step);
+      static const float cx = WorldConfig::game_radius;
+      static const float cy = WorldConfig::game_radius;
+
+      for (size_t i = 0; i < n; i++) {
+        const float a = step * (i % steps);
+        vp->Update(ss.get(), cx + path_r * cosf(a), cy + path_r * sinf(a));
+        vp->CollectChanges(ss.get());
+        vp->new_sectors.clear();
+        vp->old_sectors.clear();
+      }
+    });
+  }
+
+  {
+    // long snakes travel wide circles, so their heads enter and tails leave
+    // sectors, some of which the others occupy too
+    static const uint16_t len = 400;
+    static const size_t count = 16;
+    static const long step_ms =
+        static_cast<long>(1000 * WorldConfig::move_step_distance / Snake::base_move_speed) + 1;
+
+    auto world = NewEmptyWorld(len);
+    auto snakes = std::make_shared<std::vector<Snake *>>();
+    for (size_t i = 0; i < count; i++) {
+      snakes->push_back(NewSnake(world.get()));
+    }
+
+    r->Add("sbb_membership_churn/len=" + std::to_string(len), [world, snakes](size_t n) {
+      static const float turn = WorldConfig::move_step_distance / 3000.0f;
+
+      for (size_t i = 0; i < n; i++) {
+        Snake *s = (*snakes)[i % count];
+        s->state->wangle = Math::normalize_angle(s->state->angle + turn);
+        s->state->update = 0;
+        s->eaten.clear();
+        DoNotOptimize(s->Tick(step_ms, &world->GetSectors(), false));
+      }
+    });
+  }
+}
+
+static void RegisterRandomBenchmarks(BenchRunner *r) {
+  auto rng = std::make_shared<Random>(1);
+
+  r->Add("random_next", [rng](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      DoNotOptimize(rng->Next());
+    }
+  });
+
+  r->Add("random_next_floats/n=36", [rng](size_t n) {
+    float out[36];
+    for (size_t i = 0; i < n; i++) {
+      rng->NextFloats(out, 36);
+      DoNotOptimize(out[35]);
+    }
+  });
+
+  r->Add("std_rand", [](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      DoNotOptimize(std::rand());
+    }
+  });
+}
+
+static void RegisterMathBenchmarks(BenchRunner *r) {
+  static const size_t count = 256;
+
+  auto angles = std::make_shared<std::vector<float>>();
+  auto points = std::make_shared<std::vector<Point>>();
+  auto sines = std::make_shared<std::vector<float>>(count);
+  auto cosines = std::make_shared<std::vector<float>>(count);
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> ang(0.0f, Math::f_2pi);
+  std::uniform_real_distribution<float> pos(-1000.0f, 1000.0f);
+  for (size_t i = 0; i < count; i++) {
+    angles->push_back(ang(rng));
+    points->push_back(Point{pos(rng), pos(rng)});
+  }
+
+  // per call forms, as a movement step or a bot decision uses them
+  r->Add("math_sin_cos/libm", [angles](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      const float a = (*angles)[i & (count - 1)];
+      DoNotOptimize(sinf(a));
+      DoNotOptimize(cosf(a));
+    }
+  });
+
+  r->Add("math_sin_cos", [angles](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      float s, c;
+      Math::sin_cos((*angles)[i & (count - 1)], &s, &c);
+      DoNotOptimize(s);
+      DoNotOptimize(c);
+    }
+  });
+
+  r->Add("math_atan2/libm", [points](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      const Point &p = (*points)[i & (count - 1)];
+      DoNotOptimize(atan2f(p.y, p.x));
+    }
+  });
+
+  r->Add("math_atan2", [points](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      const Point &p = (*points)[i & (count - 1)];
+      DoNotOptimize(Math::fast_atan2(p.y, p.x));
+    }
+  });
+
+  // batch forms, per angle
+  r->Add("math_sin_cos_batch/libm/n=" + std::to_string(count), [angles, sines, cosines](size_t n) {
+    for (size_t i = 0; i < n; i += count) {
+      for (size_t j = 0; j < count; j++) {
+        (*sines)[j] = sinf((*angles)[j]);
+        (*cosines)[j] = cosf((*angles)[j]);
+      }
+      DoNotOptimize((*sines)[count - 1]);
+    }
+  });
+
+  r->Add("math_sin_cos_batch/n=" + std::to_string(count), [angles, sines, cosines](size_t n) {
+    for (size_t i = 0; i < n; i += count) {
+      Math::sin_cos(angles->data(), sines->data(), cosines->data(), count);
+      DoNotOptimize((*sines)[count - 1]);
+    }
+  });
+}
+
+void RegisterGameBenchmarks(BenchRunner *r) {
+  RegisterSnakeBenchmarks(r);
+  RegisterWorldBenchmarks(r);
+  RegisterSectorBenchmarks(r);
+  RegisterBoundBoxBenchmarks(r);
+  RegisterRandomBenchmarks(r);
+  RegisterMathBenchmarks(r);
+}
@@ -0,0 +1,152 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "bench/bench.h"
+#include "game/world.h"
+#include "packet/d_all.h"
+#include "packet/p_all.h"
+#include "server/streambuf_array.h"
+
+// the same buffers WSPPServer::send writes packets to
+template <typename T>
+static size_t Serialize(const T &packet) {
+  const size_t max = packet.get_size();
+  if (max <= 128) {
+    streambuf_array<128> buf;
+    std::ostream out(&buf);
+    out << packet;
+    return buf.size();
+  } else {
+    boost::asio::streambuf buf(max);
+    buf.prepare(max);
+
+    std::ostream out(&buf);
+    out << packet;
+    return buf.size();
+  }
+}
+
+// get_size sizes the send buffer, a short one truncates the frame
+template <typename T>
+static void CheckSize(const std::string &name, const T &packet) {
+  const size_t size = Serialize(packet);
+  if (size != packet.get_size()) {
+    std::cerr << "error: " << name << " serialized " << size << " bytes, get_size " << packet.get_size() << '\n';
+    exit(1);
+  }
+}
+
+template <typename T>
+static void AddPacket(BenchRunner *r, const std::string &name, T packet) {
+  CheckSize("packet_" + name, packet);
+  r->Add("packet_" + name, [packet](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      DoNotOptimize(Serialize(packet));
+    }
+  });
+}
+
+void RegisterPacketBenchmarks(BenchRunner *r) {
+  WorldConfig config;
+  config.bots = 0;
+  config.snake_min_length = 97;
+  config.snake_average_length = 1;
+
+  auto world = std::make_shared<World>();
+  world->Init(config);
+
+  Snake::Ptr s = world->CreateSnake(true);
+  s->name = "benchmark";
+  s->fullness = 50;
+
+  const Sector *center = world->GetSectors().get_sector(WorldConfig::sector_count_along_edge / 2,
+                                                        WorldConfig::sector_count_along_edge / 2);
+  const Food f = center->food.empty() ? Food{100, 100, 5, 3} : center->Unpack(center->food.front());
+
+  AddPacket(r, "init", PacketInit());
+  AddPacket(r, "pong", packet_pong());
+  AddPacket(r, "end", packet_end(packet_end::status_death));
+  AddPacket(r, "kill", packet_kill());
+
+  // food packets keep a pointer, the world is captured to keep it alive
+  {
+    const packet_set_food p(center);
+    const std::string name = "packet_set_food/food=" + std::to_string(center->food.size());
+    CheckSize(name, p);
+    r->Add(name, [world, p](size_t n) {
+      for (size_t i = 0; i < n; i++) {
+        DoNotOptimize(Serialize(p));
+      }
+    });
+  }
+  AddPacket(r, "spawn_food", packet_spawn_food(f));
+  AddPacket(r, "add_food", packet_add_food(f));
+  AddPacket(r, "eat_food", packet_eat_food(s->id, f));
+
+  AddPacket(r, "fullness", packet_fullness(s.get()));
+  AddPacket(r, "inc", packet_inc(s.get()));
+  AddPacket(r, "inc_rel", packet_inc_rel(s.get()));
+  AddPacket(r, "move", packet_move(s.get()));
+  AddPacket(r, "move_rel", packet_move_rel(s.get()));
+  AddPacket(r, "remove_part", packet_remove_part(s.get()));
+
+  packet_rotation rot(packet_t_rot_ccw_ang_wang_sp);
+  rot.snakeId = s->id;
+  rot.ang = 1.0f;
+  rot.wang = 2.0f;
+  rot.snakeSpeed = 5.78f;
+  AddPacket(r, "rotation", rot);
+
+  AddPacket(r, "add_sector", packet_add_sector(10, 20));
+  AddPacket(r, "remove_sector", packet_remove_sector(10, 20));
+
+  static const uint16_t lengths[] = {10, 100, 400};
+  for (uint16_t len : lengths) {
+    config.snake_min_length = static_cast<uint16_t>(len - 3);
+    auto w = std::make_shared<World>();
+    w->Init(config);
+
+    Snake::Ptr sl = w->CreateSnake(true);
+    sl->name = "benchmark";
+    const std::string name = "packet_add_snake/len=" + std::to_string(len);
+    CheckSize(name, packet_add_snake(sl.get()));
+    // the packet keeps a raw pointer
+    r->Add(name, [w, sl](size_t n) {
+      const packet_add_snake p(sl.get());
+      for (size_t i = 0; i < n; i++) {
+        DoNotOptimize(Serialize(p));
+      }
+    });
+  }
+  AddPacket(r, "remove_snake", packet_remove_snake(s->id, packet_remove_snake::status_snake_died));
+
+  packet_highscore highscore;
+  highscore.winner = s;
+  highscore.message = "benchmark highscore message";
+  AddPacket(r, "highscore", highscore);
+
+  packet_leaderboard leaderboard;
+  leaderboard.leaderboard_rank = 1;
+  leaderboard.local_rank = 1;
+  leaderboard.players = 10;
+  for (int i = 0; i < 10; i++) {
+    leaderboard.top.push_back(s);
+  }
+  AddPacket(r, "leaderboard", leaderboard);
+
+  packet_minimap minimap;
+  for (uint8_t i = 0; i < 200; i++) {
+    minimap.data.push_back(i % 2 == 0 ? 0x80 + i % 64 : i % 128);
+  }
+  AddPacket(r, "minimap", minimap);
+
+  AddPacket(r, "debug_reset", packet_debug_reset());
+
+  packet_debug_draw draw;
+  for (uint16_t i = 0; i < 20; i++) {
+    draw.circles.push_back(d_draw_circle{i, {s->get_head_x(), s->get_head_y()}, 10.0f * i, 0xc8c8c8});
+  }
+  AddPacket(r, "debug_draw", draw);
+}
@@ -0,0 +1,173 @@
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "bench/bench.h"
+#include "server/tls.h"
+
+// Self-signed certificate and key in temporary files, the server context
+// loads them by path. The files are removed with the last benchmark holding
+// them.
+class TlsFiles {
+ public:
+  TlsFiles() = default;
+  ~TlsFiles() {
+    if (!cert.empty()) {
+      unlink(cert.c_str());
+    }
+    if (!key.empty()) {
+      unlink(key.c_str());
+    }
+  }
+
+  TlsFiles(const TlsFiles &) = delete;
+  TlsFiles &operator=(const TlsFiles &) = delete;
+
+  bool Create() {
+    std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> kctx(EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr),
+                                                                     EVP_PKEY_CTX_free);
+    EVP_PKEY *raw = nullptr;
+    if (!kctx || EVP_PKEY_keygen_init(kctx.get()) != 1 || EVP_PKEY_CTX_set_rsa_keygen_bits(kctx.get(), 2048) != 1 ||
+        EVP_PKEY_keygen(kctx.get(), &raw) != 1) {
+      return false;
+    }
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> pkey(raw, EVP_PKEY_free);
+
+    std::unique_ptr<X509, decltype(&X509_free)> x509(X509_new(), X509_free);
+    X509_set_version(x509.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(x509.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509.get()), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509.get()), 24 * 3600);
+    X509_set_pubkey(x509.get(), pkey.get());
+
+    X509_NAME *name = X509_get_subject_name(x509.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("localhost"), -1,
+                               -1, 0);
+    X509_set_issuer_name(x509.get(), name);
+    if (X509_sign(x509.get(), pkey.get(), EVP_sha256()) == 0) {
+      return false;
+    }
+
+    FILE *f = Open(&cert);
+    if (f == nullptr || PEM_write_X509(f, x509.get()) != 1 || fclose(f) != 0) {
+      return false;
+    }
+    f = Open(&key);
+    if (f == nullptr || PEM_write_PrivateKey(f, pkey.get(), nullptr, nullptr, 0, nullptr, nullptr) != 1 ||
+        fclose(f) != 0) {
+      return false;
+    }
+    return true;
+  }
+
+  std::string cert;
+  std::string key;
+
+ private:
+  static FILE *Open(std::string *path) {
+    char name[] = "/tmp/slither_bench_XXXXXX";
+    const int fd = mkstemp(name);
+    if (fd < 0) {
+      return nullptr;
+    }
+    *path = name;
+    return fdopen(fd, "w");
+  }
+};
+
+// A client and a server handshake over a memory BIO pair, no sockets, so
+// only the TLS work is measured. The client resumes the given session.
+// Returns true if the session was resumed.
+static bool Handshake(SSL_CTX *server, SSL_CTX *client, SSL_SESSION *session, SSL_SESSION **established) {
+  SSL *s = SSL_new(server);
+  SSL *c = SSL_new(client);
+
+  BIO *sb = nullptr;
+  BIO *cb = nullptr;
+  BIO_new_bio_pair(&sb, 1 << 16, &cb, 1 << 16);
+  SSL_set_bio(s, sb, sb);
+  SSL_set_bio(c, cb, cb);
+  SSL_set_accept_state(s);
+  SSL_set_connect_state(c);
+  if (session != nullptr) {
+    SSL_set_session(c, session);
+  }
+
+  for (int i = 0; i < 16; i++) {
+    const int rc = SSL_do_handshake(c);
+    const int rs = SSL_do_handshake(s);
+    if (rc == 1 && rs == 1) {
+      break;
+    }
+  }
+
+  const bool reused = SSL_session_reused(c) == 1;
+  if (established != nullptr) {
+    *established = SSL_get1_session(c);
+  }
+
+  // a session is resumable only after a clean shutdown
+  SSL_shutdown(c);
+  SSL_shutdown(s);
+  SSL_shutdown(c);
+  SSL_free(s);
+  SSL_free(c);
+  return reused;
+}
+
+void RegisterTlsBenchmarks(BenchRunner *r) {
+  auto files = std::make_shared<TlsFiles>();
+  if (!files->Create()) {
+    return;
+  }
+
+  std::shared_ptr<SSL_CTX> client(SSL_CTX_new(TLS_client_method()), SSL_CTX_free);
+  SSL_CTX_set_max_proto_version(client.get(), TLS1_2_VERSION);
+
+  const std::string keys = LoadTicketKeys("");
+  TlsContextPtr shared = CreateTlsContext(files->cert, files->key, keys);
+
+  SSL_SESSION *raw = nullptr;
+  Handshake(shared->native_handle(), client.get(), nullptr, &raw);
+  std::shared_ptr<SSL_SESSION> session(raw, SSL_SESSION_free);
+
+  // the context per connection, as before it was shared
+  r->Add("tls_context", [files, keys](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      DoNotOptimize(CreateTlsContext(files->cert, files->key, keys));
+    }
+  });
+
+  r->Add("tls_handshake/context=own", [files, keys, client](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      TlsContextPtr ctx = CreateTlsContext(files->cert, files->key, keys);
+      DoNotOptimize(Handshake(ctx->native_handle(), client.get(), nullptr, nullptr));
+    }
+  });
+
+  r->Add("tls_handshake/context=shared", [shared, client](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      DoNotOptimize(Handshake(shared->native_handle(), client.get(), nullptr, nullptr));
+    }
+  });
+
+  r->Add("tls_handshake/context=shared/resumed", [shared, client, session](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      DoNotOptimize(Handshake(shared->native_handle(), client.get(), session.get(), nullptr));
+    }
+  });
+
+  // as on another worker or after a reload, only the ticket keys are common
+  TlsContextPtr other = CreateTlsContext(files->cert, files->key, keys);
+  r->Add("tls_handshake/context=other/resumed", [other, client, session](size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      DoNotOptimize(Handshake(other->native_handle(), client.get(), session.get(), nullptr));
+    }
+  });
+}
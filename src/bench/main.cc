@@ -0,0 +1,13 @@
+#include <iostream>
+
+#include "bench/bench.h"
+
+int main(const int argc, const char* const argv[]) {
+  BenchRunner runner(ParseCommandLine(argc, argv));
+
+  RegisterGameBenchmarks(&runner);
+  RegisterPacketBenchmarks(&runner);
+  RegisterTlsBenchmarks(&runner);
+
+  return runner.Run(std::cout);
+}
@@ -0,0 +1,272 @@
+#include "game/bot.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "game/math.h"
+
+constexpr float BotController::probe_angles[];
+
+void BotController::Init(const WorldConfig &in_config) {
+  budget = in_config.bot_decisions_per_tick;
+  nearby_visits.assign(nearby_visit_slots, 0);
+}
+
+void BotController::Add(Snake *s) {
+  bots.push_back(s);
+  stats.bots = bots.size();
+}
+
+void BotController::Remove(snake_id_t id) {
+  for (size_t i = 0; i < bots.size(); i++) {
+    if (bots[i]->id == id) {
+      bots[i] = bots.back();
+      bots.pop_back();
+      break;
+    }
+  }
+
+  if (cursor >= bots.size()) {
+    cursor = 0;
+  }
+  stats.bots = bots.size();
+}
+
+BotStats &BotController::GetStats() { return stats; }
+
+void BotController::Tick(long dt, SectorSeq *ss) {
+  if (bots.empty()) {
+    return;
+  }
+
+  // every bot owes one decision per ai_step_interval, spread over the frames
+  pending += dt * static_cast<long>(bots.size());
+  size_t due = static_cast<size_t>(pending / Snake::ai_step_interval);
+  if (due == 0) {
+    return;
+  }
+  pending -= due * Snake::ai_step_interval;
+
+  // over budget decisions are dropped, not carried, to keep the tick bounded
+  if (due > bots.size()) {
+    due = bots.size();
+  }
+  if (due > budget) {
+    due = budget;
+    stats.budget_hits++;
+  }
+
+  using std::chrono::steady_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  const auto start = steady_clock::now();
+
+  for (size_t i = 0; i < due; i++) {
+    if (cursor >= bots.size()) {
+      cursor = 0;
+    }
+
+    Snake *s = bots[cursor++];
+    if (!(s->state->update & (change_dying | change_dead))) {
+      Decide(s, ss);
+    }
+  }
+
+  stats.decisions += due;
+  stats.total_decisions += due;
+  stats.time_ns += duration_cast<nanoseconds>(steady_clock::now() - start).count();
+}
+
+void BotController::Decide(Snake *s, SectorSeq *ss) {
+  static const float center = WorldConfig::game_radius;
+  static const float wander_radius = WorldConfig::game_radius / 2.0f;
+  static const float look_ahead = WorldConfig::move_step_distance * 4.0f;
+
+  const float hx = s->get_head_x();
+  const float hy = s->get_head_y();
+
+  // 1. where we want to go: best food around, or wander
+  float wanted = s->state->wangle;
+  float tx, ty;
+  if (FindFood(s, ss, &tx, &ty)) {
+    wanted = Math::fast_atan2(ty - hy, tx - hx);
+  } else if (Math::distance_squared(hx, hy, center, center) > wander_radius * wander_radius) {
+    wanted = Math::fast_atan2(center - hy, center - hx);
+  }
+  wanted = Math::normalize_angle(wanted);
+
+  // 2. where we can go: keep away from bodies in front of us, otherwise take
+  // the first safe probe around the wanted direction
+  LoadNearbySnakes(s, ss);
+
+  float base = wanted;
+  if (IsDangerous(s, s->state->angle, look_ahead)) {
+    base = s->state->angle;
+  }
+
+  float angle = base;
+  for (int i = 0; i < probe_count; i++) {
+    const float probe = Math::normalize_angle(base + probe_angles[i]);
+    if (!IsDangerous(s, probe, look_ahead)) {
+      angle = probe;
+      break;
+    }
+  }
+
+  if (fabsf(s->state->wangle - angle) > 0.01f) {
+    s->state->wangle = angle;
+    s->state->update |= change_wangle;
+  }
+}
+
+void BotController::LoadNearbySnakes(const Snake *s, SectorSeq *ss) {
+  static const int16_t map_width_sectors = static_cast<int16_t>(WorldConfig::sector_count_along_edge);
+  static const float reach = WorldConfig::move_step_distance * 6.0f;
+
+  nearby.clear();
+  nearby_angle.clear();
+  if (++nearby_epoch == 0) {
+    // stamps wrapped around, forget all of them
+    std::fill(nearby_visits.begin(), nearby_visits.end(), 0);
+    nearby_epoch = 1;
+  }
+
+  const BoundBoxPos area(s->get_head_x(), s->get_head_y(), reach);
+  const int16_t sx = static_cast<int16_t>(area.x / WorldConfig::sector_size);
+  const int16_t sy = static_cast<int16_t>(area.y / WorldConfig::sector_size);
+
+  for (int16_t j = sy - 1; j <= sy + 1; j++) {
+    for (int16_t i = sx - 1; i <= sx + 1; i++) {
+      if (i < 0 || i >= map_width_sectors || j < 0 || j >= map_width_sectors) {
+        continue;
+      }
+
+      const Sector *sec = ss->get_sector(i, j);
+      for (const BoundBox *bb : sec->snakes) {
+        const Snake *s2 = bb->snake;
+        if (s2 == s || !area.Intersect(*bb)) {
+          continue;
+        }
+
+        uint16_t &visit = nearby_visits[s2->id];
+        if (visit != nearby_epoch) {
+          visit = nearby_epoch;
+          nearby.push_back(s2);
+          nearby_angle.push_back(s2->state->angle);
+        }
+      }
+    }
+  }
+
+  // foe directions, reused by every probe
+  nearby_sin.resize(nearby.size());
+  nearby_cos.resize(nearby.size());
+  Math::sin_cos(nearby_angle.data(), nearby_sin.data(), nearby_cos.data(), nearby.size());
+}
+
+bool BotController::IsDangerous(const Snake *s, float angle, float distance) const {
+  static const float center = WorldConfig::game_radius;
+  static const float safe_radius = WorldConfig::death_radius - WorldConfig::sector_size / 2.0f;
+
+  const float r = s->get_snake_body_part_radius();
+  float dx, dy;
+  Math::sin_cos(angle, &dy, &dx);
+
+  // near and far probes along the direction
+  for (int k = 1; k <= 2; k++) {
+    const float d = distance * k / 2.0f;
+    const BoundBoxPos probe(s->get_head_x() + dx * d, s->get_head_y() + dy * d, r);
+
+    if (Math::distance_squared(probe.x, probe.y, center, center) >= safe_radius * safe_radius) {
+      return true;
+    }
+
+    for (size_t i = 0; i < nearby.size(); i++) {
+      const Snake *s2 = nearby[i];
+      if (s2->Intersect(probe)) {
+        return true;
+      }
+
+      // foe head will be there by the same time too
+      const float fr = r + s2->get_snake_body_part_radius();
+      if (Math::intersect_circle(s2->get_head_x() + nearby_cos[i] * d,
+                                 s2->get_head_y() + nearby_sin[i] * d,
+                                 probe.x, probe.y, fr)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// scores up to limit food of the sector, the nearest to the head along x
+// first, returns the count scanned
+static size_t ScanFood(Sector *sec, WorldConfig::coord_t hx, WorldConfig::coord_t hy, size_t limit,
+                       float *best_score, float *tx, float *ty) {
+  static const int32_t score_dist_bias = WorldConfig::move_step_distance * WorldConfig::move_step_distance;
+
+  // head relative to the sector food
+  const int32_t lx = static_cast<int32_t>(hx) - sec->get_origin_x();
+  const int32_t ly = static_cast<int32_t>(hy) - sec->get_origin_y();
+
+  const FoodRun::iterator first = sec->food.begin();
+  const FoodRun::iterator last = sec->food.end();
+  FoodRun::iterator left = sec->FindClosestFood(hx);
+  FoodRun::iterator right = left;
+
+  size_t scanned = 0;
+  for (; scanned < limit && (left != first || right != last); scanned++) {
+    // the nearer of the two sides along x
+    const bool take_left = right == last ||
+        (left != first && lx - static_cast<int32_t>((left - 1)->x) < static_cast<int32_t>(right->x) - lx);
+    const SectorFood &f = take_left ? *--left : *right++;
+
+    // bigger and closer is better
+    const int32_t dx = static_cast<int32_t>(f.x) - lx;
+    const int32_t dy = static_cast<int32_t>(f.y) - ly;
+    const float score = 1.0f * f.size / (dx * dx + dy * dy + score_dist_bias);
+    if (score > *best_score) {
+      *best_score = score;
+      *tx = static_cast<float>(sec->get_origin_x() + f.x);
+      *ty = static_cast<float>(sec->get_origin_y() + f.y);
+    }
+  }
+
+  return scanned;
+}
+
+bool BotController::FindFood(const Snake *s, SectorSeq *ss, float *tx, float *ty) const {
+  static const int16_t map_width_sectors = static_cast<int16_t>(WorldConfig::sector_count_along_edge);
+  static const size_t max_food_scan = 128;
+  static const size_t max_head_food_scan = max_food_scan / 2;
+  static const int16_t neighbours[8][2] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+  const WorldConfig::coord_t hx = static_cast<WorldConfig::coord_t>(s->get_head_x());
+  const WorldConfig::coord_t hy = static_cast<WorldConfig::coord_t>(s->get_head_y());
+  const int16_t sx = static_cast<int16_t>(hx / WorldConfig::sector_size);
+  const int16_t sy = static_cast<int16_t>(hy / WorldConfig::sector_size);
+
+  float best_score = 0.0f;
+  size_t remaining = max_food_scan;
+
+  // the head sector first, then the neighbours share what it left of the
+  // scan cap, so crowded sectors can not starve the ones after them
+  if (sx >= 0 && sx < map_width_sectors && sy >= 0 && sy < map_width_sectors) {
+    remaining -= ScanFood(ss->get_sector(sx, sy), hx, hy, max_head_food_scan, &best_score, tx, ty);
+  }
+
+  for (size_t k = 0; k < 8 && remaining > 0; k++) {
+    const int16_t i = sx + neighbours[k][0];
+    const int16_t j = sy + neighbours[k][1];
+    if (i < 0 || i >= map_width_sectors || j < 0 || j >= map_width_sectors) {
+      continue;
+    }
+
+    const size_t limit = std::max<size_t>(1, remaining / (8 - k));
+    remaining -= ScanFood(ss->get_sector(i, j), hx, hy, limit, &best_score, tx, ty);
+  }
+
+  return best_score > 0.0f;
+}
@@ -0,0 +1,72 @@
+#ifndef SRC_GAME_BOT_H_
+#define SRC_GAME_BOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "game/config.h"
+#include "game/sector.h"
+#include "game/snake.h"
+
+struct BotStats {
+  size_t bots = 0;
+  uint64_t decisions = 0;
+  uint64_t budget_hits = 0;      // ticks where the decision budget was exhausted
+  uint64_t time_ns = 0;          // wall time spent in bot decisions
+  uint64_t total_decisions = 0;  // since start, kept on Reset
+
+  void Reset() {
+    decisions = 0;
+    budget_hits = 0;
+    time_ns = 0;
+  }
+};
+
+// Bot controller. Every bot picks a target angle once per
+// Snake::ai_step_interval, bots never boost. Decisions are staggered round
+// robin over frames so the work is spread evenly between ticks, and capped by
+// a global per tick budget so a large bot population can not stall the
+// simulation.
+class BotController {
+ public:
+  void Init(const WorldConfig &in_config);
+
+  void Add(Snake *s);
+  void Remove(snake_id_t id);
+
+  void Tick(long dt, SectorSeq *ss);
+
+  BotStats &GetStats();
+
+ private:
+  void Decide(Snake *s, SectorSeq *ss);
+  void LoadNearbySnakes(const Snake *s, SectorSeq *ss);
+  bool IsDangerous(const Snake *s, float angle, float distance) const;
+  bool FindFood(const Snake *s, SectorSeq *ss, float *tx, float *ty) const;
+
+ private:
+  std::vector<Snake *> bots;
+  // perception scratch, reused between decisions
+  std::vector<const Snake *> nearby;
+  std::vector<float> nearby_angle;
+  std::vector<float> nearby_sin;
+  std::vector<float> nearby_cos;
+  // stamps by snake id, a snake in several of the sectors is loaded once
+  std::vector<uint16_t> nearby_visits;
+  uint16_t nearby_epoch = 0;
+  static const size_t nearby_visit_slots = 1 << (8 * sizeof(snake_id_t));
+
+  size_t cursor = 0;
+  long pending = 0;  // bots * ticks owed to the schedule, in ms units
+  uint16_t budget = 0;
+
+  BotStats stats;
+
+  // probe directions, relative to the base direction, checked in order
+  static constexpr float probe_angles[] = {0.0f, 0.4f, -0.4f, 0.8f, -0.8f,
+                                           1.3f, -1.3f, 1.9f, -1.9f, 3.14f};
+  static const int probe_count = sizeof(probe_angles) / sizeof(probe_angles[0]);
+};
+
+#endif  // SRC_GAME_BOT_H_
@@ -3,6 +3,8 @@
 
 #include <cstdint>
 
+#include "game/geometry.h"
+
 typedef uint16_t snake_id_t;
 
 struct WorldConfig {
@@ -13,15 +15,25 @@ struct WorldConfig {
   uint16_t snake_average_length = 2;
   uint16_t snake_min_length = 2;
 
-  static const uint16_t game_radius = 21600;
+  // max bot decisions made in one tick, over budget ones are dropped
+  uint16_t bot_decisions_per_tick = 256;
+
+  // step interval of bots out of every viewport, ms, 0 - full rate
+  uint16_t bot_lod_interval = 500;
+
+  // random generator seed, 0 - seed from time
+  uint32_t seed = 0;
+
+  typedef WorldGeometry::sector_index_t sector_index_t;
+  typedef WorldGeometry::coord_t coord_t;
+
+  static const uint32_t game_radius = WorldGeometry::game_radius;
   static const uint16_t max_snake_parts = 411;
-  static const uint16_t sector_size = 300;
-  // sector_count_along_edge = 144
-  static const uint16_t sector_count_along_edge = 2 * game_radius / sector_size;
-  static const uint16_t death_radius = game_radius - sector_size;
-  // sector_diag_size = 1 + sqrtf(sector_size * sector_size * 2)
-  static const uint16_t sector_diag_size = 425;
-  static const uint16_t move_step_distance = 42;
+  static const uint16_t sector_size = WorldGeometry::sector_size;
+  static const uint16_t sector_count_along_edge = WorldGeometry::sector_count_along_edge;
+  static const uint32_t death_radius = WorldGeometry::death_radius;
+  static const uint16_t sector_diag_size = WorldGeometry::sector_diag_size;
+  static const uint16_t move_step_distance = WorldGeometry::move_step_distance;
 
   static const long frame_time_ms = 8;
   static const uint8_t protocol_version = 8;
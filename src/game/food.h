@@ -4,9 +4,13 @@
 #include <cstdint>
 #include <vector>
 
+#include "game/config.h"
+
 struct Food {
-  uint16_t x;
-  uint16_t y;
+  typedef WorldConfig::coord_t coord_t;
+
+  coord_t x;
+  coord_t y;
 
   uint8_t size;
   uint8_t color;  // at least 28 types of colors
@@ -16,11 +20,26 @@ struct Food {
   uint16_t _padding = 0;
 
   Food() = default;
-  Food(uint16_t in_x, uint16_t in_y, uint8_t in_size, uint8_t in_color)
+  Food(coord_t in_x, coord_t in_y, uint8_t in_size, uint8_t in_color)
       : x(in_x), y(in_y), size(in_size), color(in_color) { }
 };
 
 typedef std::vector<Food> FoodSeq;
 typedef std::vector<Food>::iterator FoodSeqIter;
 
+// Food as a sector keeps it, the position is relative to the sector origin.
+// Food never leaves its sector, so 9 bits per axis are enough, see
+// Sector::Pack and Sector::Unpack for the conversion. Sizes are at most 100,
+// colors are food palette or skin indices. x takes the top bits, sectors keep
+// food sorted by it.
+struct SectorFood {
+  uint32_t color : 7;
+  uint32_t size : 7;
+  uint32_t y : 9;
+  uint32_t x : 9;
+};
+
+static_assert(sizeof(SectorFood) == 4, "sector food is packed");
+static_assert(WorldConfig::sector_size <= 512, "sector food offsets are 9 bit");
+
 #endif  // SRC_GAME_FOOD_H_
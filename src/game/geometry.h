@@ -0,0 +1,48 @@
+#ifndef SRC_GAME_GEOMETRY_H_
+#define SRC_GAME_GEOMETRY_H_
+
+#include <cstdint>
+#include <limits>
+
+// World geometry. All the sizes are compile time constants, so the sector
+// and collision loops of every variant are constant folded. A build picks one
+// variant, see WorldGeometry below.
+//
+// SectorIndex holds a sector column or row, Coord a map position in pixels.
+template <uint32_t GameRadius, uint16_t SectorSize, uint16_t MoveStepDistance,
+          typename SectorIndex, typename Coord>
+struct Geometry {
+  typedef SectorIndex sector_index_t;
+  typedef Coord coord_t;
+
+  static const uint32_t game_radius = GameRadius;
+  static const uint16_t sector_size = SectorSize;
+  static const uint16_t sector_count_along_edge = 2 * GameRadius / SectorSize;
+  static const uint32_t death_radius = GameRadius - SectorSize;
+  // 1 + sqrtf(sector_size * sector_size * 2)
+  static const uint16_t sector_diag_size = SectorSize * 141422u / 100000u + 1;
+  static const uint16_t move_step_distance = MoveStepDistance;
+
+  static_assert(2 * GameRadius % SectorSize == 0, "map edge must be whole sectors");
+  static_assert(sector_count_along_edge - 1 <= std::numeric_limits<SectorIndex>::max(),
+                "sector index type is too narrow");
+  static_assert(2 * GameRadius <= std::numeric_limits<Coord>::max(), "coordinate type is too narrow");
+};
+
+// event arenas, 48 x 48 sectors
+typedef Geometry<7200, 300, 42, uint8_t, uint16_t> SmallGeometry;
+// slither.io map, 144 x 144 sectors
+typedef Geometry<21600, 300, 42, uint8_t, uint16_t> DefaultGeometry;
+// peak hours, 288 x 288 sectors, does not fit 8 bit sectors and 16 bit
+// coordinates of the stock protocol
+typedef Geometry<43200, 300, 42, uint16_t, uint32_t> LargeGeometry;
+
+#if defined(SLITHER_GEOMETRY_SMALL)
+typedef SmallGeometry WorldGeometry;
+#elif defined(SLITHER_GEOMETRY_LARGE)
+typedef LargeGeometry WorldGeometry;
+#else
+typedef DefaultGeometry WorldGeometry;
+#endif
+
+#endif  // SRC_GAME_GEOMETRY_H_
@@ -0,0 +1,158 @@
+#include "game/journal.h"
+
+#include <algorithm>
+
+static const char journal_magic[] = {'S', 'L', 'J'};
+// 2 - world random generator is xoshiro128**
+static const uint8_t journal_version = 2;
+
+bool JournalWriter::Open(const std::string &path, const WorldConfig &config) {
+  out.open(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+
+  out.write(journal_magic, sizeof(journal_magic));
+  Write8(journal_version);
+  Write32(config.seed);
+  Write16(config.bots);
+  Write16(config.snake_average_length);
+  Write16(config.snake_min_length);
+  Write16(config.bot_decisions_per_tick);
+  Write16(config.bot_lod_interval);
+
+  return static_cast<bool>(out);
+}
+
+bool JournalWriter::IsOpen() const { return out.is_open(); }
+
+void JournalWriter::Close() {
+  if (out.is_open()) {
+    out.close();
+  }
+}
+
+void JournalWriter::Flush() {
+  if (out.is_open()) {
+    out.flush();
+  }
+}
+
+void JournalWriter::Tick(long dt) {
+  if (out.is_open()) {
+    Write8(journal_tick);
+    Write16(static_cast<uint16_t>(std::min(dt, 0xFFFFL)));
+  }
+}
+
+void JournalWriter::Join(snake_id_t id) {
+  if (out.is_open()) {
+    Write8(journal_join);
+    Write16(id);
+  }
+}
+
+void JournalWriter::Leave(snake_id_t id) {
+  if (out.is_open()) {
+    Write8(journal_leave);
+    Write16(id);
+  }
+}
+
+void JournalWriter::Packet(snake_id_t id, const std::string &payload) {
+  // on_message drops anything longer
+  if (out.is_open() && payload.size() <= 255) {
+    Write8(journal_packet);
+    Write16(id);
+    Write8(static_cast<uint8_t>(payload.size()));
+    out.write(payload.data(), payload.size());
+  }
+}
+
+void JournalWriter::Write8(uint8_t v) { out.put(static_cast<char>(v)); }
+
+void JournalWriter::Write16(uint16_t v) {
+  Write8(static_cast<uint8_t>(v));
+  Write8(static_cast<uint8_t>(v >> 8));
+}
+
+void JournalWriter::Write32(uint32_t v) {
+  Write16(static_cast<uint16_t>(v));
+  Write16(static_cast<uint16_t>(v >> 16));
+}
+
+bool JournalReader::Open(const std::string &path) {
+  in.open(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+
+  char magic[sizeof(journal_magic)];
+  uint8_t version = 0;
+  if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), journal_magic) ||
+      !Read8(&version) || version != journal_version) {
+    return false;
+  }
+
+  return Read32(&config.seed) && Read16(&config.bots) && Read16(&config.snake_average_length) &&
+         Read16(&config.snake_min_length) && Read16(&config.bot_decisions_per_tick) &&
+         Read16(&config.bot_lod_interval);
+}
+
+const WorldConfig &JournalReader::GetConfig() const { return config; }
+
+bool JournalReader::Next(JournalRecord *r) {
+  uint8_t type = 0;
+  if (!Read8(&type)) {
+    return false;
+  }
+
+  r->type = static_cast<journal_record_t>(type);
+  switch (r->type) {
+    case journal_tick:
+      return Read16(&r->dt);
+
+    case journal_join:
+    case journal_leave:
+      return Read16(&r->id);
+
+    case journal_packet: {
+      uint8_t len = 0;
+      if (!Read16(&r->id) || !Read8(&len)) {
+        return false;
+      }
+      r->payload.resize(len);
+      return len == 0 || static_cast<bool>(in.read(&r->payload[0], len));
+    }
+
+    default:
+      return false;
+  }
+}
+
+bool JournalReader::Read8(uint8_t *v) {
+  char c;
+  if (!in.get(c)) {
+    return false;
+  }
+  *v = static_cast<uint8_t>(c);
+  return true;
+}
+
+bool JournalReader::Read16(uint16_t *v) {
+  uint8_t lo, hi;
+  if (!Read8(&lo) || !Read8(&hi)) {
+    return false;
+  }
+  *v = static_cast<uint16_t>(lo | hi << 8);
+  return true;
+}
+
+bool JournalReader::Read32(uint32_t *v) {
+  uint16_t lo, hi;
+  if (!Read16(&lo) || !Read16(&hi)) {
+    return false;
+  }
+  *v = static_cast<uint32_t>(lo) | static_cast<uint32_t>(hi) << 16;
+  return true;
+}
@@ -0,0 +1,76 @@
+#ifndef SRC_GAME_JOURNAL_H_
+#define SRC_GAME_JOURNAL_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "game/config.h"
+
+// Journal of everything that drives the world: the config with the actual
+// seed in the header, then a stream of records. Ticks carry the loop step
+// time, all records between two ticks belong to the same step. Multibyte
+// values are little endian.
+//
+// header:  'S' 'L' 'J' version(1) seed(4) bots(2) avg_len(2) min_len(2)
+//          bot_budget(2) bot_lod(2)
+// records: 'T' dt(2)            - game loop step, ms
+//          'J' id(2)            - player joined, snake created
+//          'L' id(2)            - player left, snake removed
+//          'P' id(2) len(1) ... - inbound packet accepted from player
+enum journal_record_t : uint8_t {
+  journal_tick = 'T',
+  journal_join = 'J',
+  journal_leave = 'L',
+  journal_packet = 'P',
+};
+
+struct JournalRecord {
+  journal_record_t type = journal_tick;
+  uint16_t dt = 0;
+  snake_id_t id = 0;
+  std::string payload;
+};
+
+class JournalWriter {
+ public:
+  // config.seed must be the one the world was initialized with
+  bool Open(const std::string &path, const WorldConfig &config);
+  bool IsOpen() const;
+  void Close();
+  void Flush();
+
+  // all no-op if the journal is not open
+  void Tick(long dt);
+  void Join(snake_id_t id);
+  void Leave(snake_id_t id);
+  void Packet(snake_id_t id, const std::string &payload);
+
+ private:
+  void Write8(uint8_t v);
+  void Write16(uint16_t v);
+  void Write32(uint32_t v);
+
+ private:
+  std::ofstream out;
+};
+
+class JournalReader {
+ public:
+  bool Open(const std::string &path);
+  const WorldConfig &GetConfig() const;
+
+  // false on end of journal or a malformed record
+  bool Next(JournalRecord *r);
+
+ private:
+  bool Read8(uint8_t *v);
+  bool Read16(uint16_t *v);
+  bool Read32(uint32_t *v);
+
+ private:
+  std::ifstream in;
+  WorldConfig config;
+};
+
+#endif  // SRC_GAME_JOURNAL_H_
@@ -1,5 +1,11 @@
 #include "game/math.h"
 
+void Math::sin_cos(const float *ang, float *s, float *c, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    sin_cos(ang[i], s + i, c + i);
+  }
+}
+
 bool Math::intersect_segments(float p0_x, float p0_y, float p1_x, float p1_y,
                                      float p2_x, float p2_y, float p3_x, float p3_y) {
   const float s1_x = p1_x - p0_x;
@@ -54,3 +60,9 @@ int32_t Math::distance_squared(uint16_t p0_x, uint16_t p0_y, uint16_t p1_x, uint
   return dx * dx + dy * dy;
 }
 
+int64_t Math::distance_squared(uint32_t p0_x, uint32_t p0_y, uint32_t p1_x, uint32_t p1_y) {
+  const int64_t dx = static_cast<int64_t>(p0_x) - p1_x;
+  const int64_t dy = static_cast<int64_t>(p0_y) - p1_y;
+  return dx * dx + dy * dy;
+}
+
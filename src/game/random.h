@@ -0,0 +1,96 @@
+#ifndef SRC_GAME_RANDOM_H_
+#define SRC_GAME_RANDOM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// xoshiro128** pseudo random generator (Blackman, Vigna), seeded through
+// splitmix64. Small, fast and deterministic for a given seed on every
+// platform, unlike std::rand. An instance is not thread safe, parallel users
+// take their own stream, see Jump().
+class Random {
+ public:
+  Random() { Seed(1); }
+  explicit Random(uint64_t seed) { Seed(seed); }
+
+  void Seed(uint64_t seed) {
+    for (uint32_t &v : s) {
+      // splitmix64
+      uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      v = static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+    }
+  }
+
+  inline uint32_t Next() {
+    const uint32_t result = rotl(s[1] * 5, 7) * 9;
+    const uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 11);
+
+    return result;
+  }
+
+  // [0, bound), multiply shift reduction without division
+  inline uint32_t Next(uint32_t bound) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(Next()) * bound) >> 32);
+  }
+
+  // [0, 1), 24 bits of mantissa
+  inline float NextFloat() { return (Next() >> 8) * (1.0f / 16777216.0f); }
+
+  inline void NextFloats(float *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = NextFloat();
+    }
+  }
+
+  // raw state, to save and resume the sequence
+  void GetState(uint32_t out[4]) const {
+    for (int i = 0; i < 4; i++) {
+      out[i] = s[i];
+    }
+  }
+
+  void SetState(const uint32_t in[4]) {
+    for (int i = 0; i < 4; i++) {
+      s[i] = in[i];
+    }
+  }
+
+  // Advances the state by 2^64 steps. Streams taken from the same seed with
+  // a different number of jumps do not overlap.
+  void Jump() {
+    static const uint32_t jump[] = {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b};
+
+    uint32_t t[4] = {0, 0, 0, 0};
+    for (uint32_t j : jump) {
+      for (int b = 0; b < 32; b++) {
+        if (j & (1u << b)) {
+          t[0] ^= s[0];
+          t[1] ^= s[1];
+          t[2] ^= s[2];
+          t[3] ^= s[3];
+        }
+        Next();
+      }
+    }
+
+    for (int i = 0; i < 4; i++) {
+      s[i] = t[i];
+    }
+  }
+
+ private:
+  static inline uint32_t rotl(const uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+  uint32_t s[4];
+};
+
+#endif  // SRC_GAME_RANDOM_H_
@@ -2,31 +2,11 @@
 
 #include <algorithm>
 
-void BoundBox::Insert(Sector *s) {
-  auto fwd_i = std::lower_bound(sectors.begin(), sectors.end(), s);
-  if (fwd_i != sectors.end()) {
-    sectors.insert(fwd_i, s);
-  } else {
-    sectors.push_back(s);
-  }
-}
+#include "game/snake.h"
 
-bool BoundBox::RemoveUnsorted(const SectorIter &i) {
-  if (i + 1 != sectors.end()) {
-    *i = sectors.back();
-    sectors.pop_back();
-    return true;
-  } else {
-    sectors.pop_back();
-    return false;
-  }
-}
-
-bool BoundBox::IsPresent(const Sector *s) {
-  return std::binary_search(sectors.begin(), sectors.end(), s);
-}
-
-void BoundBox::Sort() { std::sort(sectors.begin(), sectors.end()); }
+constexpr uint32_t FoodArena::min_capacity;
+constexpr uint32_t SnakeBoundBox::no_member;
+constexpr size_t SnakeBoundBox::min_members;
 
 size_t BoundBox::get_sectors_count() { return sectors.size(); }
 
@@ -38,47 +18,140 @@ size_t BoundBox::get_snakes_in_sectors_count() {
   return i;
 }
 
-void Sector::RemoveSnake(snake_id_t id) {
-  snakes.erase(std::remove_if(
-      snakes.begin(), snakes.end(),
-      [id](const BoundBox *bb) { return bb->id == id; }), snakes.end());
+SectorFood Sector::Pack(Food f) const {
+  static const int32_t last = WorldConfig::sector_size - 1;
+  const int32_t fx = static_cast<int32_t>(f.x) - get_origin_x();
+  const int32_t fy = static_cast<int32_t>(f.y) - get_origin_y();
+
+  SectorFood sf;
+  sf.x = static_cast<uint32_t>(std::min(std::max(fx, 0), last));
+  sf.y = static_cast<uint32_t>(std::min(std::max(fy, 0), last));
+  sf.size = std::min<uint32_t>(f.size, 127);
+  sf.color = f.color & 127u;
+  return sf;
 }
 
-void Sector::Insert(Food f) {
-  auto fwd_i = std::lower_bound(
-      food.begin(), food.end(), f,
-      [](const Food &a, const Food &b) { return a.x < b.x; });
+void FoodArena::Init(size_t sectors) {
+  items.clear();
+  runs.assign(sectors, Run{0, 0, 0});
+  holes = 0;
+  live = 0;
+}
 
-  if (fwd_i != food.end()) {
-    food.insert(fwd_i, f);
-  } else {
-    food.push_back(f);
+void FoodArena::Load(const SectorFood *food, const uint32_t *index) {
+  std::vector<SectorFood> to_items;
+  to_items.reserve(index[runs.size()] * 3 / 2 + runs.size() * min_capacity);
+  for (uint32_t i = 0; i < runs.size(); i++) {
+    Place(&to_items, i, food + index[i], index[i + 1] - index[i]);
+  }
+
+  items.swap(to_items);
+  holes = 0;
+  live = index[runs.size()];
+}
+
+bool FoodArena::IsSparse() const {
+  return holes > live;
+}
+
+void FoodArena::Compact() {
+  std::vector<SectorFood> to_items;
+  to_items.reserve(items.size() - holes);
+  for (uint32_t i = 0; i < runs.size(); i++) {
+    Place(&to_items, i, items.data() + runs[i].offset, runs[i].count);
+  }
+
+  items.swap(to_items);
+  holes = 0;
+}
+
+void FoodArena::Reserve(uint32_t i, uint32_t n) {
+  Run &run = runs[i];
+  if (n <= run.capacity) {
+    return;
+  }
+
+  const uint32_t to = static_cast<uint32_t>(items.size());
+  items.resize(to + n);
+  std::copy(items.begin() + run.offset, items.begin() + run.offset + run.count, items.begin() + to);
+  holes += run.capacity;
+  run.offset = to;
+  run.capacity = n;
+}
+
+void FoodArena::Place(std::vector<SectorFood> *to_items, uint32_t i, const SectorFood *first, uint32_t n) {
+  const size_t to = to_items->size();
+  const uint32_t room = std::max(min_capacity, n + n / 2);
+  to_items->insert(to_items->end(), first, first + n);
+  to_items->resize(to + room);
+
+  runs[i] = Run{static_cast<uint32_t>(to), n, room};
+}
+
+void FoodRun::Insert(SectorFood f) {
+  const FoodArena::Run &run = arena->runs[index];
+  if (run.count == run.capacity) {
+    arena->Reserve(index, std::max(FoodArena::min_capacity, 2 * run.capacity));
   }
+
+  SectorFood *const last = end();
+  SectorFood *const fwd_i = std::lower_bound(
+      begin(), last, f,
+      [](const SectorFood &a, const SectorFood &b) { return a.x < b.x; });
+
+  std::copy_backward(fwd_i, last, last + 1);
+  *fwd_i = f;
+  arena->runs[index].count++;
+  arena->live++;
+}
+
+void FoodRun::Erase(iterator i) {
+  std::copy(i + 1, end(), i);
+  arena->runs[index].count--;
+  arena->live--;
 }
 
-void Sector::Remove(const FoodSeqIter &i) {
-  food.erase(i);
+void FoodRun::clear() {
+  arena->live -= size();
+  arena->runs[index].count = 0;
+}
+
+void Sector::Insert(Food f) {
+  food.Insert(Pack(f));
+}
+
+void Sector::Remove(FoodRun::iterator i) {
+  food.Erase(i);
 }
 
 void Sector::Sort() {
   std::sort(food.begin(), food.end(),
-            [](const Food &a, const Food &b) { return a.x < b.x; });
+            [](const SectorFood &a, const SectorFood &b) { return a.x < b.x; });
 }
 
-FoodSeqIter Sector::FindClosestFood(uint16_t fx) {
+FoodRun::iterator Sector::FindClosestFood(WorldConfig::coord_t fx) {
+  const WorldConfig::coord_t ox = get_origin_x();
+  if (fx <= ox) {
+    return food.begin();
+  }
+
+  const uint32_t lx = fx - ox;
   return std::lower_bound(
-      food.begin(), food.end(), Food{fx, 0, 0, 0},
-      [](const Food &a, const Food &b) { return a.x < b.x; });
+      food.begin(), food.end(), lx,
+      [](const SectorFood &a, uint32_t b) { return a.x < b; });
 }
 
 void SectorSeq::InitSectors() {
   const size_t len = WorldConfig::sector_count_along_edge *
                      WorldConfig::sector_count_along_edge;
   reserve(len);
+  food_arena.Init(len);
   for (size_t i = 0; i < len; i++) {
     push_back(Sector{
-        static_cast<uint8_t>(i % WorldConfig::sector_count_along_edge),
-        static_cast<uint8_t>(i / WorldConfig::sector_count_along_edge)});
+        static_cast<Sector::index_t>(i % WorldConfig::sector_count_along_edge),
+        static_cast<Sector::index_t>(i / WorldConfig::sector_count_along_edge)});
+    back().food.arena = &food_arena;
+    back().food.index = static_cast<uint32_t>(i);
   }
 }
 
@@ -90,26 +163,112 @@ Sector *SectorSeq::get_sector(const uint16_t x, const uint16_t y) {
   return &operator[](get_index(x, y));
 }
 
-void SnakeBoundBox::InsertSortedWithReg(Sector *s) {
-  Insert(s);
-  s->snakes.push_back(this);
+// fibonacci hashing, neighbour sectors have close indexes
+static inline size_t GetMemberSlot(uint32_t index, size_t mask) {
+  return ((index * 2654435761u) >> 16) & mask;
+}
+
+bool SnakeBoundBox::IsMember(const Sector *s) const {
+  if (members.empty()) {
+    return false;
+  }
+
+  const uint32_t index = s->get_index();
+  const size_t mask = members.size() - 1;
+  for (size_t i = GetMemberSlot(index, mask);; i = (i + 1) & mask) {
+    if (members[i] == index) {
+      return true;
+    }
+    if (members[i] == no_member) {
+      return false;
+    }
+  }
+}
+
+void SnakeBoundBox::AddMember(uint32_t index) {
+  if (2 * (sectors.size() + 1) > members.size()) {
+    // rehash the sectors to twice the space
+    members.assign(std::max(min_members, 2 * members.size()), no_member);
+    for (const Sector *s : sectors) {
+      InsertMember(s->get_index());
+    }
+  }
+
+  InsertMember(index);
+}
+
+void SnakeBoundBox::InsertMember(uint32_t index) {
+  const size_t mask = members.size() - 1;
+  size_t i = GetMemberSlot(index, mask);
+  while (members[i] != no_member) {
+    i = (i + 1) & mask;
+  }
+  members[i] = index;
 }
 
-void ViewPort::RegNewSectorIfMissing(Sector *s) {
-  if (std::find(new_sectors.begin(), new_sectors.end(), s) == new_sectors.end()) {
-    new_sectors.push_back(s);
+void SnakeBoundBox::RemoveMember(uint32_t index) {
+  const size_t mask = members.size() - 1;
+  size_t hole = GetMemberSlot(index, mask);
+  while (members[hole] != index) {
+    hole = (hole + 1) & mask;
+  }
+
+  // move back the entries of the probe run that can not be found past the hole
+  for (size_t j = (hole + 1) & mask; members[j] != no_member; j = (j + 1) & mask) {
+    const size_t home = GetMemberSlot(members[j], mask);
+    if (((j - home) & mask) >= ((j - hole) & mask)) {
+      members[hole] = members[j];
+      hole = j;
+    }
   }
+  members[hole] = no_member;
 }
 
-void ViewPort::RegOldSectorIfMissing(Sector *s) {
-  if (std::find(old_sectors.begin(), old_sectors.end(), s) == old_sectors.end()) {
-    old_sectors.push_back(s);
+void SnakeBoundBox::Join(Sector *s) {
+  AddMember(s->get_index());
+  slots.push_back(static_cast<uint32_t>(s->snakes.size()));
+  s->snake_slots.push_back(static_cast<uint32_t>(sectors.size()));
+  s->snakes.push_back(this);
+  sectors.push_back(s);
+  if (s->viewers > 0) {
+    snake->state->observed++;
   }
 }
 
-void ViewPort::InsertSortedWithDelta(Sector *s) {
-  Insert(s);
-  RegNewSectorIfMissing(s);
+void SnakeBoundBox::Leave(size_t k) {
+  Sector *s = sectors[k];
+  const uint32_t i = slots[k];
+  RemoveMember(s->get_index());
+  if (s->viewers > 0) {
+    snake->state->observed--;
+  }
+
+  // the last snake of the sector takes our slot
+  const size_t last = s->snakes.size() - 1;
+  if (i != last) {
+    SnakeBoundBox *moved = s->snakes[last];
+    s->snakes[i] = moved;
+    s->snake_slots[i] = s->snake_slots[last];
+    moved->slots[s->snake_slots[i]] = i;
+  }
+  s->snakes.pop_back();
+  s->snake_slots.pop_back();
+
+  // our last sector takes its slot
+  const size_t back = sectors.size() - 1;
+  if (k != back) {
+    sectors[k] = sectors[back];
+    slots[k] = slots[back];
+    sectors[k]->snake_slots[slots[k]] = static_cast<uint32_t>(k);
+  }
+  sectors.pop_back();
+  slots.pop_back();
+}
+
+void SnakeBoundBox::LeaveAll() {
+  while (!sectors.empty()) {
+    Leave(sectors.size() - 1);
+  }
 }
 
 void SnakeBoundBox::UpdateBoxNewSectors(SectorSeq *ss, const float bb_r,
@@ -131,8 +290,8 @@ void SnakeBoundBox::UpdateBoxNewSectors(SectorSeq *ss, const float bb_r,
     for (int i = new_sx - 1; i <= new_sx + 1; i++) {
       if (i >= 0 && i < map_width_sectors && j >= 0 && j < map_width_sectors) {
         Sector *new_sector = ss->get_sector(i, j);
-        if (!IsPresent(new_sector) && new_sector->Intersect(box)) {
-          InsertSortedWithReg(new_sector);
+        if (new_sector->Intersect(box) && !IsMember(new_sector)) {
+          Join(new_sector);
         }
       }
     }
@@ -140,73 +299,178 @@ void SnakeBoundBox::UpdateBoxNewSectors(SectorSeq *ss, const float bb_r,
 }
 
 void SnakeBoundBox::UpdateBoxOldSectors() {
-  const size_t prev_len = sectors.size();
-  auto i = sectors.begin();
-  auto sec_end = sectors.end();
-  while (i != sec_end) {
-    Sector *sec = *i;
-    if (!sec->Intersect(*this)) {
-      sec->RemoveSnake(id);
-      if (RemoveUnsorted(i)) {
-        sec_end = sectors.end();
-        continue;
-      } else {
-        break;
+  size_t k = 0;
+  while (k < sectors.size()) {
+    if (!sectors[k]->Intersect(*this)) {
+      // the last sector moves into k, check it next
+      Leave(k);
+    } else {
+      k++;
+    }
+  }
+}
+
+// view masks of the 7 rows around the head sector by the head cell, bit 0 is
+// the leftmost sector
+struct ViewStencils {
+  static const int16_t width = 2 * ViewPort::stencil_half + 1;
+  uint8_t rows[ViewPort::stencil_steps * ViewPort::stencil_steps][width];
+
+  ViewStencils() {
+    static const float step = 1.0f * WorldConfig::sector_size / ViewPort::stencil_steps;
+    // as Sector::Intersect with the view box
+    static const float reach = WorldConfig::sector_diag_size / 2.0f + ViewPort::view_radius;
+
+    for (uint16_t cy = 0; cy < ViewPort::stencil_steps; cy++) {
+      for (uint16_t cx = 0; cx < ViewPort::stencil_steps; cx++) {
+        const float hx = (cx + 0.5f) * step;
+        const float hy = (cy + 0.5f) * step;
+        uint8_t *cell_rows = rows[cy * ViewPort::stencil_steps + cx];
+
+        for (int16_t dy = -ViewPort::stencil_half; dy <= ViewPort::stencil_half; dy++) {
+          uint8_t mask = 0;
+          for (int16_t dx = -ViewPort::stencil_half; dx <= ViewPort::stencil_half; dx++) {
+            const float sx = (dx + 0.5f) * WorldConfig::sector_size;
+            const float sy = (dy + 0.5f) * WorldConfig::sector_size;
+            if (Math::intersect_circle(sx, sy, hx, hy, reach)) {
+              mask |= static_cast<uint8_t>(1 << (dx + ViewPort::stencil_half));
+            }
+          }
+          cell_rows[dy + ViewPort::stencil_half] = mask;
+        }
       }
     }
-    i++;
+  }
+};
+
+static const uint8_t *GetViewStencil(size_t cell) {
+  static const ViewStencils stencils;
+  return stencils.rows[cell];
+}
+
+void ViewPort::Update(SectorSeq *ss, const float head_x, const float head_y) {
+  static const float step = 1.0f * WorldConfig::sector_size / stencil_steps;
+  static const int16_t max_step = stencil_steps - 1;
+
+  const int16_t sx = static_cast<int16_t>(head_x / WorldConfig::sector_size);
+  const int16_t sy = static_cast<int16_t>(head_y / WorldConfig::sector_size);
+  const int16_t qx = std::min(max_step, static_cast<int16_t>((head_x - sx * WorldConfig::sector_size) / step));
+  const int16_t qy = std::min(max_step, static_cast<int16_t>((head_y - sy * WorldConfig::sector_size) / step));
+
+  const int32_t new_cell = ((sy * WorldConfig::sector_count_along_edge + sx) * stencil_steps + qy) *
+                           stencil_steps + qx;
+  if (new_cell == cell) {
+    return;
   }
 
-  if (prev_len != sectors.size()) {
-    Sort();
+  if (bits.empty()) {
+    bits.assign(WorldConfig::sector_count_along_edge * words_per_row, 0);
+    shown.assign(bits.size(), 0);
   }
+
+  // rows of the old view and the new one
+  const int16_t row_lo = (cell < 0 ? sy : std::min(view_sy, sy)) - stencil_half;
+  const int16_t row_hi = (cell < 0 ? sy : std::max(view_sy, sy)) + stencil_half;
+
+  cell = new_cell;
+  view_sy = sy;
+  UpdateRows(ss, row_lo, row_hi, GetViewStencil(std::max<int16_t>(qy, 0) * stencil_steps + std::max<int16_t>(qx, 0)),
+             sy - stencil_half, sx - stencil_half);
 }
 
-void ViewPort::UpdateBoxNewSectors(SectorSeq *ss,
-                                   const float new_x, const float new_y,
-                                   const float old_x, const float old_y) {
-  const int16_t new_sx = static_cast<int16_t>(new_x / WorldConfig::sector_size);
-  const int16_t new_sy = static_cast<int16_t>(new_y / WorldConfig::sector_size);
-  const int16_t old_sx = static_cast<int16_t>(old_x / WorldConfig::sector_size);
-  const int16_t old_sy = static_cast<int16_t>(old_y / WorldConfig::sector_size);
-  if (new_sx == old_sx && new_sy == old_sy) {
+// the snakes of a sector entering or leaving the player views
+static void Observe(const Sector *s, int16_t d) {
+  for (const SnakeBoundBox *box : s->snakes) {
+    box->snake->state->observed += d;
+  }
+}
+
+void ViewPort::UpdateRows(SectorSeq *ss, int16_t row_lo, int16_t row_hi, const uint8_t *rows,
+                          int16_t rows_y, int16_t rows_x) {
+  static const int16_t edge = static_cast<int16_t>(WorldConfig::sector_count_along_edge);
+
+  row_lo = std::max<int16_t>(row_lo, 0);
+  row_hi = std::min<int16_t>(row_hi, edge - 1);
+  if (row_lo > row_hi) {
     return;
   }
 
-  static const int16_t map_width_sectors =
-      static_cast<int16_t>(WorldConfig::sector_count_along_edge);
+  for (int16_t j = row_lo; j <= row_hi; j++) {
+    uint64_t row[words_per_row] = {};
 
-  for (int j = new_sy - 3; j <= new_sy + 3; j++) {
-    for (int i = new_sx - 3; i <= new_sx + 3; i++) {
-      if (i >= 0 && i < map_width_sectors && j >= 0 && j < map_width_sectors) {
-        Sector *new_sector = ss->get_sector(i, j);
-        if (!IsPresent(new_sector) && new_sector->Intersect(*this)) {
-          InsertSortedWithDelta(new_sector);
+    const int16_t k = j - rows_y;
+    if (rows != nullptr && k >= 0 && k <= 2 * stencil_half) {
+      uint64_t mask = rows[k];
+      int16_t col = rows_x;
+      if (col < 0) {
+        mask >>= -col;
+        col = 0;
+      }
+      if (col < edge) {
+        if (edge - col < 8) {
+          mask &= (1u << (edge - col)) - 1;
+        }
+        const int16_t w = col / 64;
+        const int16_t b = col % 64;
+        row[w] |= mask << b;
+        if (b > 64 - 8 && w + 1 < static_cast<int16_t>(words_per_row)) {
+          row[w + 1] |= mask >> (64 - b);
+        }
+      }
+    }
+
+    uint64_t *cur = &bits[j * words_per_row];
+    for (size_t w = 0; w < words_per_row; w++) {
+      uint64_t entered = row[w] & ~cur[w];
+      uint64_t left = cur[w] & ~row[w];
+      for (; entered != 0; entered &= entered - 1) {
+        Sector *s = ss->get_sector(static_cast<uint16_t>(w * 64 + __builtin_ctzll(entered)), j);
+        if ((s->*count)++ == 0 && count == &Sector::viewers) {
+          Observe(s, 1);
+        }
+      }
+      for (; left != 0; left &= left - 1) {
+        Sector *s = ss->get_sector(static_cast<uint16_t>(w * 64 + __builtin_ctzll(left)), j);
+        if (--(s->*count) == 0 && count == &Sector::viewers) {
+          Observe(s, -1);
         }
       }
+      cur[w] = row[w];
     }
   }
+
+  if (dirty_lo > dirty_hi) {
+    dirty_lo = row_lo;
+    dirty_hi = row_hi;
+  } else {
+    dirty_lo = std::min(dirty_lo, row_lo);
+    dirty_hi = std::max(dirty_hi, row_hi);
+  }
 }
 
-void ViewPort::UpdateBoxOldSectors() {
-  const size_t prev_len = sectors.size();
-  auto i = sectors.begin();
-  auto sec_end = sectors.end();
-  while (i != sec_end) {
-    Sector *sec = *i;
-    if (!sec->Intersect(*this)) {
-      RegOldSectorIfMissing(sec);
-      if (RemoveUnsorted(i)) {
-        sec_end = sectors.end();
-        continue;
-      } else {
-        break;
+void ViewPort::CollectChanges(SectorSeq *ss) {
+  for (int16_t j = dirty_lo; j <= dirty_hi; j++) {
+    for (size_t w = 0; w < words_per_row; w++) {
+      const size_t i = j * words_per_row + w;
+      uint64_t added = bits[i] & ~shown[i];
+      uint64_t removed = shown[i] & ~bits[i];
+      for (; added != 0; added &= added - 1) {
+        new_sectors.push_back(ss->get_sector(static_cast<uint16_t>(w * 64 + __builtin_ctzll(added)), j));
       }
+      for (; removed != 0; removed &= removed - 1) {
+        old_sectors.push_back(ss->get_sector(static_cast<uint16_t>(w * 64 + __builtin_ctzll(removed)), j));
+      }
+      shown[i] = bits[i];
     }
-    i++;
   }
 
-  if (prev_len != sectors.size()) {
-    Sort();
+  dirty_lo = 1;
+  dirty_hi = 0;
+}
+
+void ViewPort::Clear(SectorSeq *ss) {
+  if (cell >= 0) {
+    UpdateRows(ss, view_sy - stencil_half, view_sy + stencil_half, nullptr, 0, 0);
+    cell = -1;
   }
 }
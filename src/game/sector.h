@@ -13,10 +13,12 @@
 class Snake;
 class Sector;
 class BoundBox;
+class SnakeBoundBox;
 
 typedef std::vector<Sector *> SectorVec;
 typedef std::vector<Sector *>::iterator SectorIter;
 typedef std::vector<BoundBox *> BoundBoxVec;
+typedef std::vector<SnakeBoundBox *> SnakeBoundBoxVec;
 
 struct BoundBoxPos {
   float x;
@@ -32,6 +34,74 @@ struct BoundBoxPos {
   }
 };
 
+// Food of all the sectors in one array, in compressed sparse rows by sector
+// index: sector i owns items[runs[i].offset .. runs[i].offset + capacity),
+// its food sorted by x at the front and slack behind. A full run moves to the
+// end of the array with twice the room, Compact lays all the runs out again
+// in sector order. Whole world scans go over runs and items linearly, without
+// touching the sectors. Pointers to food are valid until the next insert into
+// any sector.
+class FoodArena {
+ public:
+  struct Run {
+    uint32_t offset;
+    uint32_t count;
+    uint32_t capacity;
+  };
+
+  static constexpr uint32_t min_capacity = 8;
+
+  void Init(size_t sectors);
+  // sector i food is food[index[i]] .. food[index[i + 1]]
+  void Load(const SectorFood *food, const uint32_t *index);
+  // runs that moved away take more room than the live ones
+  bool IsSparse() const;
+  void Compact();
+
+  inline size_t get_size() const { return live; }
+  inline const std::vector<Run> &get_runs() const { return runs; }
+  inline const SectorFood *get_items() const { return items.data(); }
+
+ private:
+  friend class FoodRun;
+
+  // moves run i to the end, if it has less room
+  void Reserve(uint32_t i, uint32_t n);
+  // appends the food with slack to to_items, run i is there then
+  void Place(std::vector<SectorFood> *to_items, uint32_t i, const SectorFood *first, uint32_t n);
+
+  std::vector<SectorFood> items;
+  std::vector<Run> runs;
+  // items of the runs that moved away
+  size_t holes = 0;
+  size_t live = 0;
+};
+
+// Food of a sector, its run of the arena.
+class FoodRun {
+ public:
+  typedef SectorFood *iterator;
+  typedef const SectorFood *const_iterator;
+
+  inline iterator begin() { return arena->items.data() + arena->runs[index].offset; }
+  inline iterator end() { return begin() + size(); }
+  inline const_iterator begin() const { return arena->items.data() + arena->runs[index].offset; }
+  inline const_iterator end() const { return begin() + size(); }
+  inline size_t size() const { return arena->runs[index].count; }
+  inline bool empty() const { return size() == 0; }
+  inline const SectorFood &front() const { return *begin(); }
+
+  void Insert(SectorFood f);
+  void Erase(iterator i);
+  void clear();
+
+ private:
+  friend class SectorSeq;
+
+  FoodArena *arena = nullptr;
+  uint32_t index = 0;
+};
+
 class BoundBox : public BoundBoxPos {
  public:
   snake_id_t id;
@@ -42,25 +112,30 @@ class BoundBox : public BoundBoxPos {
   BoundBox(BoundBoxPos in_pos, uint16_t in_id, const Snake *in_snake, SectorVec in_sectors)
       : BoundBoxPos(in_pos), id(in_id), snake(in_snake), sectors(in_sectors) {}
 
-  void Insert(Sector *s);
-  bool RemoveUnsorted(const SectorIter &i);
-  bool IsPresent(const Sector *s);
-  void Sort();
-
   size_t get_sectors_count();
   size_t get_snakes_in_sectors_count();
 };
 
 class Sector {
  public:
-  uint8_t x;
-  uint8_t y;
+  typedef WorldConfig::sector_index_t index_t;
 
-  BoundBoxPos box;
-  BoundBoxVec snakes;
-  FoodSeq food;
+  index_t x;
+  index_t y;
 
-  Sector(uint8_t in_x, uint8_t in_y) : x(in_x), y(in_y) {
+  BoundBoxPos box;
+  // snakes[i] has this sector at snake_slots[i] of its sectors
+  SnakeBoundBoxVec snakes;
+  std::vector<uint32_t> snake_slots;
+  FoodRun food;
+
+  // count of viewports the sector is in, bots in it are ticked in full
+  uint16_t viewers = 0;
+  // count of spectator viewports, apart from viewers, as spectators are not
+  // journaled and must not change the bots ticks on replay
+  uint16_t spectators = 0;
+
+  Sector(index_t in_x, index_t in_y) : x(in_x), y(in_y) {
     static const uint16_t half = WorldConfig::sector_size / 2;
     static constexpr float r = WorldConfig::sector_diag_size / 2.0f;
 
@@ -72,26 +147,62 @@ class Sector {
     return box.Intersect(box2);
   }
 
+  // position in SectorSeq
+  inline uint32_t get_index() const {
+    return static_cast<uint32_t>(y) * WorldConfig::sector_count_along_edge + x;
+  }
+
+  inline WorldConfig::coord_t get_origin_x() const {
+    return static_cast<WorldConfig::coord_t>(x * WorldConfig::sector_size);
+  }
+  inline WorldConfig::coord_t get_origin_y() const {
+    return static_cast<WorldConfig::coord_t>(y * WorldConfig::sector_size);
+  }
+
+  // positions out of the sector are clamped to its edge
+  SectorFood Pack(Food f) const;
+  inline Food Unpack(const SectorFood &f) const {
+    return Food(static_cast<WorldConfig::coord_t>(get_origin_x() + f.x),
+                static_cast<WorldConfig::coord_t>(get_origin_y() + f.y),
+                static_cast<uint8_t>(f.size), static_cast<uint8_t>(f.color));
+  }
+
   void Insert(Food f);
-  void Remove(const FoodSeqIter &i);
-  FoodSeqIter FindClosestFood(uint16_t fx);
+  void Remove(FoodRun::iterator i);
+  // first food at or right of the map x
+  FoodRun::iterator FindClosestFood(WorldConfig::coord_t fx);
   void Sort();
-
-  void RemoveSnake(snake_id_t id);
 };
 
 class SectorSeq : public std::vector<Sector> {
  public:
   SectorSeq() : std::vector<Sector>() {}
+  // sectors point to the arena
+  SectorSeq(const SectorSeq &) = delete;
+  SectorSeq &operator=(const SectorSeq &) = delete;
 
   void InitSectors();
 
+  inline FoodArena &get_food_arena() { return food_arena; }
+  inline const FoodArena &get_food_arena() const { return food_arena; }
+
   size_t get_index(const uint16_t x, const uint16_t y);
   Sector *get_sector(const uint16_t x, const uint16_t y);
+
+ private:
+  FoodArena food_arena;
 };
 
+// Snake body sectors. Membership is intrusive both ways, the box keeps its
+// slot in every sector snakes list and the sector keeps its slot in the box
+// sectors, so joining and leaving a sector are O(1) swaps with the last
+// entry. Neither list is sorted, IsMember looks the sector up in a small
+// hash set of the member sector indexes instead.
 class SnakeBoundBox : public BoundBox {
  public:
+  // sectors[k] has this box at slots[k] of its snakes
+  std::vector<uint32_t> slots;
+
   SnakeBoundBox() = default;
 
   SnakeBoundBox(BoundBoxPos in_pos, uint16_t in_id,
@@ -100,34 +211,72 @@ class SnakeBoundBox : public BoundBox {
 
   explicit SnakeBoundBox(BoundBox in) : BoundBox({in.x, in.y, in.r}, in.id, in.snake, in.sectors) {}
 
-  void InsertSortedWithReg(Sector *s);
+  bool IsMember(const Sector *s) const;
+  void Join(Sector *s);
+  void Leave(size_t k);
+  void LeaveAll();
+
   void UpdateBoxNewSectors(SectorSeq *ss, const float bb_r,
                            const float new_x, const float new_y,
                            const float old_x, const float old_y);
   void UpdateBoxOldSectors();
+
+ private:
+  void AddMember(uint32_t index);
+  void InsertMember(uint32_t index);
+  void RemoveMember(uint32_t index);
+
+  // sector indexes, open addressing with linear probing, at most half full
+  std::vector<uint32_t> members;
+  static constexpr uint32_t no_member = 0xffffffff;
+  static constexpr size_t min_members = 16;
 };
 
-class ViewPort : public BoundBox {
+// Sectors a player sees around the head. Membership is a bitset over the
+// sector grid, filled from precomputed stencils: the head position within its
+// sector is quantized to a stencil_steps x stencil_steps cell and every cell
+// has the 7 x 7 mask of sectors the view circle intersects from its center.
+// The view is recomputed only when the cell changes, and sectors entering and
+// leaving come out as bitwise diffs of the rows.
+class ViewPort : public BoundBoxPos {
  public:
+  // filled by CollectChanges, cleared by the sender
   SectorVec new_sectors;
   SectorVec old_sectors;
+  // sector count the view is kept in
+  uint16_t Sector::*count = &Sector::viewers;
 
-  ViewPort() = default;
-
-  ViewPort(BoundBoxPos in_pos, uint16_t in_id, const Snake *in_ptr, const SectorVec &in_sectors)
-      : BoundBox(in_pos, in_id, in_ptr, in_sectors) {}
-
-  explicit ViewPort(BoundBox in) : BoundBox({in.x, in.y, in.r}, in.id, in.snake, in.sectors) {}
-
-  void RegNewSectorIfMissing(Sector *s);
-  void RegOldSectorIfMissing(Sector *s);
+  static const uint16_t view_radius = 3 * WorldConfig::sector_diag_size;
+  static const uint16_t stencil_steps = 8;
+  static const int16_t stencil_half = 3;
+  static const size_t words_per_row = (WorldConfig::sector_count_along_edge + 63) / 64;
 
-  void InsertSortedWithDelta(Sector *s);
+  ViewPort() = default;
 
-  void UpdateBoxNewSectors(SectorSeq *ss,
-                           const float new_x, const float new_y,
-                           const float old_x, const float old_y);
-  void UpdateBoxOldSectors();
+  explicit ViewPort(BoundBoxPos in) : BoundBoxPos(in) {}
+
+  // moves the view to the head position, keeps sector counts
+  void Update(SectorSeq *ss, const float head_x, const float head_y);
+  // sectors the client has to add and remove since the last call
+  void CollectChanges(SectorSeq *ss);
+  // leaves all the sectors
+  void Clear(SectorSeq *ss);
+
+ private:
+  // sets rows row_lo..row_hi to the stencil rows placed at rows_x, rows_y,
+  // or clears them if rows is nullptr
+  void UpdateRows(SectorSeq *ss, int16_t row_lo, int16_t row_hi, const uint8_t *rows,
+                  int16_t rows_y, int16_t rows_x);
+
+  // sectors in view, and those the client was sent, by grid rows
+  std::vector<uint64_t> bits;
+  std::vector<uint64_t> shown;
+  // view cell of the last update, -1 if none
+  int32_t cell = -1;
+  int16_t view_sy = 0;
+  // rows where bits and shown may differ
+  int16_t dirty_lo = 1;
+  int16_t dirty_hi = 0;
 };
 
 #endif  // SRC_GAME_SECTOR_H_
@@ -1,173 +1,185 @@
 #include "game/snake.h"
 
+#include <algorithm>
 #include <iostream>
 #include <array>
 
 #include "game/math.h"
 
-bool Snake::Tick(long dt, SectorSeq *ss) {
+bool Snake::Tick(long dt, SectorSeq *ss, bool coarse) {
+  SnakeTickState &st = *state;
   uint8_t changes = 0;
 
-  if (update & (change_dying | change_dead)) {
+  if (st.update & (change_dying | change_dead)) {
     return false;
   }
 
-  if (bot) {
-    ai_ticks += dt;
-    if (ai_ticks > ai_step_interval) {
-      const long frames = ai_ticks / ai_step_interval;
-      const long frames_ticks = frames * ai_step_interval;
-
-      TickAI(frames);
-
-      ai_ticks -= frames_ticks;
-    }
-  }
-
   // rotation
-  if (angle != wangle) {
-    rot_ticks += dt;
-    if (rot_ticks >= rot_step_interval) {
-      const long frames = rot_ticks / rot_step_interval;
+  if (st.angle != st.wangle) {
+    st.rot_ticks += dt;
+    if (st.rot_ticks >= rot_step_interval) {
+      const long frames = st.rot_ticks / rot_step_interval;
       const long frames_ticks = frames * rot_step_interval;
       const float rotation = snake_angular_speed * frames_ticks / 1000.0f;
-      float dAngle = Math::normalize_angle(wangle - angle);
+      float dAngle = Math::normalize_angle(st.wangle - st.angle);
 
       if (dAngle > Math::f_pi) {
         dAngle -= Math::f_2pi;
       }
 
       if (fabsf(dAngle) < rotation) {
-        angle = wangle;
+        st.angle = st.wangle;
       } else {
-        angle += rotation * (dAngle > 0 ? 1.0f : -1.0f);
+        st.angle += rotation * (dAngle > 0 ? 1.0f : -1.0f);
       }
 
-      angle = Math::normalize_angle(angle);
+      st.angle = Math::normalize_angle(st.angle);
 
       changes |= change_angle;
-      rot_ticks -= frames_ticks;
+      st.rot_ticks -= frames_ticks;
     }
   }
 
   // movement
-  mov_ticks += dt;
-  const long mov_frame_interval = 1000 * WorldConfig::move_step_distance / speed;
-  if (mov_ticks >= mov_frame_interval) {
-    const long frames = mov_ticks / mov_frame_interval;
+  st.mov_ticks += dt;
+  const long mov_frame_interval = 1000 * WorldConfig::move_step_distance / st.speed;
+  if (st.mov_ticks >= mov_frame_interval) {
+    const long frames = st.mov_ticks / mov_frame_interval;
     const long frames_ticks = frames * mov_frame_interval;
-    const float move_dist = speed * frames_ticks / 1000.0f;
-    const size_t len = parts.size();
-
-    // move head
-    Body &head = parts[0];
-    Body prev = head;
-    head.x += cosf(angle) * move_dist;
-    head.y += sinf(angle) * move_dist;
-
-    sbb.UpdateBoxNewSectors(ss, WorldConfig::sector_size / 2, head.x, head.y,
-                            prev.x, prev.y);
-    if (!bot) {
-      vp.UpdateBoxNewSectors(ss, head.x, head.y, prev.x, prev.y);
-    }
-
-    // bound box
-    float bbx = head.x;
-    float bby = head.y;
-
-    for (size_t i = 1; i < len && i < parts_skip_count; ++i) {
-      const Body old = parts[i];
-      parts[i] = prev;
-      bbx += prev.x;
-      bby += prev.y;
-      prev = old;
-    }
-
-    // move intermediate
-    for (size_t i = parts_skip_count, j = 0; i < len && i < parts_skip_count + parts_start_move_count; ++i) {
-      Body &pt = parts[i];
-      const Body last = parts[i - 1];
-      const Body old = pt;
-
-      pt.From(prev);
-      const float move_coeff = snake_tail_k * (++j) / parts_start_move_count;
-      pt.Offset(move_coeff * (last.x - pt.x), move_coeff * (last.y - pt.y));
-
-      bbx += pt.x;
-      bby += pt.y;
-      prev = old;
-    }
 
-    // move tail
-    for (size_t i = parts_skip_count + parts_start_move_count, j = 0; i < len; ++i) {
-      Body &pt = parts[i];
-      const Body last = parts[i - 1];
-      const Body old = pt;
-
-      pt.From(prev);
-      pt.Offset(snake_tail_k * (last.x - pt.x), snake_tail_k * (last.y - pt.y));
-
-      // as far as having step dist = 42, k = 0.43, sec. size = 300, this could
-      // be 300 / 24.0f, with radius 150
-      static const size_t tail_step =
-          static_cast<size_t>(WorldConfig::sector_size / tail_step_distance);
-      if (j + tail_step >= i) {
-        sbb.UpdateBoxNewSectors(ss, WorldConfig::sector_size / 2, pt.x, pt.y,
-                                old.x, old.y);
-        j = i;
+    if (coarse) {
+      // catch up every missed step, but register only the head on the way,
+      // the tail follows its path and is refreshed with the last step
+      const float step_dist = st.speed * mov_frame_interval / 1000.0f;
+      for (long i = 1; i < frames; ++i) {
+        Move(step_dist, ss, false);
       }
-
-      bbx += pt.x;
-      bby += pt.y;
-      prev = old;
+      Move(step_dist, ss, true);
+    } else {
+      Move(st.speed * frames_ticks / 1000.0f, ss, true);
     }
 
     changes |= change_pos;
 
-    // update bb
-    sbb.x = bbx / parts.size();
-    sbb.y = bby / parts.size();
-    vp.x = head.x;
-    vp.y = head.y;
-    UpdateBoxRadius();
     sbb.UpdateBoxOldSectors();
-    if (!bot) {
-      vp.UpdateBoxOldSectors();
-    }
     UpdateEatenFood(ss);
 
     // update speed
-    if (acceleration) {
+    if (st.acceleration) {
       if (parts.size() <= 3) {
-        acceleration = false;
+        st.acceleration = false;
       } else {
         DecreaseSnake(33);
       }
     }
 
-    const uint16_t wantedSpeed = acceleration ? boost_speed : base_move_speed;
-    if (speed != wantedSpeed) {
-      const float sgn = wantedSpeed > speed ? 1.0f : -1.0f;
+    const uint16_t wantedSpeed = st.acceleration ? boost_speed : base_move_speed;
+    if (st.speed != wantedSpeed) {
+      const float sgn = wantedSpeed > st.speed ? 1.0f : -1.0f;
       const uint16_t acc = static_cast<uint16_t>(speed_acceleration * frames_ticks / 1000.0f);
-      if (abs(wantedSpeed - speed) <= acc) {
-        speed = wantedSpeed;
+      if (abs(wantedSpeed - st.speed) <= acc) {
+        st.speed = wantedSpeed;
       } else {
-        speed += sgn * acc;
+        st.speed += sgn * acc;
       }
       changes |= change_speed;
     }
 
-    mov_ticks -= frames_ticks;
+    st.mov_ticks -= frames_ticks;
   }
 
-  if (changes > 0 && changes != update) {
-    update |= changes;
+  if (changes > 0 && changes != st.update) {
+    st.update |= changes;
     return true;
   }
 
   return false;
 }
 
+void Snake::Move(float move_dist, SectorSeq *ss, bool tail_sectors) {
+  const size_t len = parts.size();
+
+  // move head
+  Body &head = parts[0];
+  Body prev = head;
+  float dir_sin, dir_cos;
+  Math::sin_cos(state->angle, &dir_sin, &dir_cos);
+  head.x += dir_cos * move_dist;
+  head.y += dir_sin * move_dist;
+
+  // farthest part from the old box center
+  const float cx = sbb.x;
+  const float cy = sbb.y;
+  float far2 = Math::distance_squared(head.x, head.y, cx, cy);
+
+  sbb.UpdateBoxNewSectors(ss, WorldConfig::sector_size / 2, head.x, head.y,
+                          prev.x, prev.y);
+  if (!bot) {
+    vp.Update(ss, head.x, head.y);
+  }
+
+  // bound box
+  float bbx = head.x;
+  float bby = head.y;
+
+  for (size_t i = 1; i < len && i < parts_skip_count; ++i) {
+    const Body old = parts[i];
+    parts[i] = prev;
+    bbx += prev.x;
+    bby += prev.y;
+    far2 = std::max(far2, Math::distance_squared(prev.x, prev.y, cx, cy));
+    prev = old;
+  }
+
+  // move intermediate
+  for (size_t i = parts_skip_count, j = 0; i < len && i < parts_skip_count + parts_start_move_count; ++i) {
+    Body &pt = parts[i];
+    const Body last = parts[i - 1];
+    const Body old = pt;
+
+    pt.From(prev);
+    const float move_coeff = snake_tail_k * (++j) / parts_start_move_count;
+    pt.Offset(move_coeff * (last.x - pt.x), move_coeff * (last.y - pt.y));
+
+    bbx += pt.x;
+    bby += pt.y;
+    far2 = std::max(far2, Math::distance_squared(pt.x, pt.y, cx, cy));
+    prev = old;
+  }
+
+  // move tail
+  for (size_t i = parts_skip_count + parts_start_move_count, j = 0; i < len; ++i) {
+    Body &pt = parts[i];
+    const Body last = parts[i - 1];
+    const Body old = pt;
+
+    pt.From(prev);
+    pt.Offset(snake_tail_k * (last.x - pt.x), snake_tail_k * (last.y - pt.y));
+
+    // as far as having step dist = 42, k = 0.43, sec. size = 300, this could
+    // be 300 / 24.0f, with radius 150
+    static const size_t tail_step =
+        static_cast<size_t>(WorldConfig::sector_size / tail_step_distance);
+    if (tail_sectors && j + tail_step >= i) {
+      sbb.UpdateBoxNewSectors(ss, WorldConfig::sector_size / 2, pt.x, pt.y,
+                              old.x, old.y);
+      j = i;
+    }
+
+    bbx += pt.x;
+    bby += pt.y;
+    far2 = std::max(far2, Math::distance_squared(pt.x, pt.y, cx, cy));
+    prev = old;
+  }
+
+  // update bb, the new center is at most its shift away from the old one
+  sbb.x = bbx / len;
+  sbb.y = bby / len;
+  sbb.r = sqrtf(far2) + sqrtf(Math::distance_squared(cx, cy, sbb.x, sbb.y));
+  vp.x = head.x;
+  vp.y = head.y;
+}
+
 std::shared_ptr<Snake> Snake::get_ptr() { return shared_from_this(); }
 
 void Snake::UpdateBoxCenter() {
@@ -191,18 +203,14 @@ void Snake::UpdateBoxCenter() {
 }
 
 void Snake::UpdateBoxRadius() {
-  // calculate bb radius, len eval for step dist = 42, k = 0.43
-  // parts ..  1  ..  2  ..  3   ..  4   ..  5   ..  6   ..  7  .. tail by 24.0f
-  float d = 42.0f + 42.0f + 42.0f + 37.7f + 37.7f + 33.0f + 28.5f;
-
-  if (parts.size() > 8) {
-    d += tail_step_distance * (parts.size() - 8);
+  // every part is within the radius, Move keeps it so
+  float far2 = 0.0f;
+  for (const Body &p : parts) {
+    far2 = std::max(far2, Math::distance_squared(p.x, p.y, sbb.x, sbb.y));
   }
+  sbb.r = sqrtf(far2);
 
-  // reserve 1 step ahead of the snake radius
-  sbb.r = (d + WorldConfig::move_step_distance) / 2.0f;
-
-  vp.r = WorldConfig::sector_diag_size * 3.0f;
+  vp.r = ViewPort::view_radius;
 }
 
 void Snake::InitBoxNewSectors(SectorSeq *ss) {
@@ -211,7 +219,7 @@ void Snake::InitBoxNewSectors(SectorSeq *ss) {
                           0.0f, 0.0f);
 
   if (!bot) {
-    vp.UpdateBoxNewSectors(ss, head.x, head.y, 0.0f, 0.0f);
+    vp.Update(ss, head.x, head.y);
   }
 
   const size_t len = parts.size();
@@ -226,8 +234,8 @@ void Snake::InitBoxNewSectors(SectorSeq *ss) {
 }
 
 void Snake::UpdateEatenFood(SectorSeq *ss) {
-  const uint16_t hx = static_cast<uint16_t>(get_head_x());
-  const uint16_t hy = static_cast<uint16_t>(get_head_y());
+  const WorldConfig::coord_t hx = static_cast<WorldConfig::coord_t>(get_head_x());
+  const WorldConfig::coord_t hy = static_cast<WorldConfig::coord_t>(get_head_y());
   const uint16_t r = static_cast<uint16_t>(14 + get_snake_body_part_radius() +
                                            WorldConfig::move_step_distance);
   const int32_t r2 = r * r;
@@ -238,15 +246,19 @@ void Snake::UpdateEatenFood(SectorSeq *ss) {
   // head sector
   {
     Sector *sec = ss->get_sector(sx, sy);
+    // food is relative to the sector
+    const uint16_t lx = static_cast<uint16_t>(hx - sec->get_origin_x());
+    const uint16_t ly = static_cast<uint16_t>(hy - sec->get_origin_y());
     auto begin = sec->food.begin();
     auto i = sec->FindClosestFood(hx);
     // to left
     {
       auto left = i - 1;
-      while (left >= begin && Math::distance_squared(left->x, left->y, hx, hy) <= r2) {
+      while (left >= begin && Math::distance_squared(static_cast<uint16_t>(left->x),
+                                                     static_cast<uint16_t>(left->y), lx, ly) <= r2) {
         // std::cout << "eaten food <left> x = " << left->x << ", y = " <<
         // left->y << std::endl;
-        on_food_eaten(*left);
+        on_food_eaten(sec->Unpack(*left));
         sec->Remove(left);
         i--;
         left--;
@@ -255,10 +267,11 @@ void Snake::UpdateEatenFood(SectorSeq *ss) {
     // to right
     {
       auto end = sec->food.end();
-      while (i < end && Math::distance_squared(i->x, i->y, hx, hy) <= r2) {
+      while (i < end && Math::distance_squared(static_cast<uint16_t>(i->x),
+                                               static_cast<uint16_t>(i->y), lx, ly) <= r2) {
         // std::cout << "eaten food <right> x = " << i->x << ", y = " << i->y <<
         // std::endl;
-        on_food_eaten(*i);
+        on_food_eaten(sec->Unpack(*i));
         sec->Remove(i);
         end--;
       }
@@ -270,21 +283,6 @@ BoundBox Snake::get_new_box() const {
   return {{get_head_x(), get_head_y(), 0}, id, this, {}};
 }
 
-void Snake::TickAI(long frames) {
-  for (auto i = 0; i < frames; i++) {
-    // 1. calc angle of radius vector
-    float ai_angle = atan2f(get_head_y() - WorldConfig::game_radius,
-                            get_head_x() - WorldConfig::game_radius);
-    // 2. add pi_2
-    ai_angle = Math::normalize_angle(ai_angle + Math::f_pi / 2.0f);
-    // 3. set
-    if (fabsf(wangle - ai_angle) > 0.01f) {
-      wangle = ai_angle;
-      update |= change_wangle;
-    }
-  }
-}
-
 bool Snake::Intersect(BoundBoxPos foe, BodySeqCIter prev, BodySeqCIter iter, BodySeqCIter end) const {
   while (iter != end) {
     // weak body part check
@@ -358,7 +356,7 @@ void Snake::IncreaseSnake(uint16_t volume) {
     fullness -= 100;
     parts.push_back(parts.back());
   }
-  update |= change_fullness;
+  state->update |= change_fullness;
   UpdateSnakeConsts();
 }
 
@@ -369,8 +367,8 @@ void Snake::DecreaseSnake(uint16_t volume) {
     for (uint16_t i = 0; i < reduce; i++) {
       if (parts.size() > 3) {
         const Body &last = parts.back();
-        SpawnFood({static_cast<uint16_t>(last.x),
-                   static_cast<uint16_t>(last.y),
+        SpawnFood({static_cast<Food::coord_t>(last.x),
+                   static_cast<Food::coord_t>(last.y),
                    100,  // TODO(john.koepi) size dep on snake mass, use random
                    skin});
         parts.pop_back();
@@ -380,7 +378,7 @@ void Snake::DecreaseSnake(uint16_t volume) {
   } else {
     fullness -= volume;
   }
-  update |= change_fullness;
+  state->update |= change_fullness;
   UpdateSnakeConsts();
 }
 
@@ -397,26 +395,35 @@ void Snake::SpawnFood(Food f) {
   }
 }
 
-void Snake::on_dead_food_spawn(SectorSeq *ss, std::function<float()> next_randomf) {
+void Snake::on_dead_food_spawn(SectorSeq *ss, Random *rng) {
   auto end = parts.end();
 
   const float r = get_snake_body_part_radius();
   const uint16_t r2 = static_cast<uint16_t>(r * 3);
 
-  const size_t count = static_cast<size_t>(sc * 2);
+  // sc <= 6
+  static const size_t max_count = 12;
+  const size_t count = std::min(max_count, static_cast<size_t>(sc * 2));
   const uint8_t food_size = static_cast<uint8_t>(100 / count);
 
+  // x, y, color for every food of a part
+  float rnd[3 * max_count];
+
   for (auto i = parts.begin(); i != end; ++i) {
     const uint16_t sx = static_cast<uint16_t>(i->x / WorldConfig::sector_size);
     const uint16_t sy = static_cast<uint16_t>(i->y / WorldConfig::sector_size);
     if (sx > 0 && sx < WorldConfig::sector_count_along_edge - 1 && sy > 0 &&
         sy < WorldConfig::sector_count_along_edge - 1) {
+      rng->NextFloats(rnd, 3 * count);
       for (size_t j = 0; j < count; j++) {
-        Food f = {static_cast<uint16_t>(i->x + r - next_randomf() * r2),
-                  static_cast<uint16_t>(i->y + r - next_randomf() * r2),
-                  food_size, static_cast<uint8_t>(29 * next_randomf())};
-
-        Sector *sec = ss->get_sector(sx, sy);
+        const float *v = rnd + 3 * j;
+        Food f = {static_cast<Food::coord_t>(i->x + r - v[0] * r2),
+                  static_cast<Food::coord_t>(i->y + r - v[1] * r2),
+                  food_size, static_cast<uint8_t>(29 * v[2])};
+
+        // food scatters around the part, it goes to the sector it lands in,
+        // which is next to the part one at most
+        Sector *sec = ss->get_sector(f.x / WorldConfig::sector_size, f.y / WorldConfig::sector_size);
         sec->Insert(f);
         spawn.push_back(f);
       }
@@ -426,7 +433,7 @@ void Snake::on_dead_food_spawn(SectorSeq *ss, std::function<float()> next_random
 
 float Snake::get_snake_scale() const { return gsc; }
 
-float Snake::get_snake_body_part_radius() const { return sbpr; }
+float Snake::get_snake_body_part_radius() const { return state->sbpr; }
 
 std::array<float, WorldConfig::max_snake_parts> get_fmlts() {
   std::array<float, WorldConfig::max_snake_parts> data = {{0.0f}};
@@ -467,5 +474,5 @@ void Snake::UpdateSnakeConsts() {
   ssp = nsp1 + nsp2 * sc;
   fsp = ssp + 0.1f;
 
-  sbpr = 29.0f * 0.5f /* render mode 2 const */ * sc;
+  state->sbpr = 29.0f * 0.5f /* render mode 2 const */ * sc;
 }
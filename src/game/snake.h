@@ -9,6 +9,7 @@
 #include <unordered_map>
 
 #include "game/config.h"
+#include "game/random.h"
 #include "game/sector.h"
 
 enum snake_changes_t : uint8_t {
@@ -45,37 +46,70 @@ struct Body {
 typedef std::vector<Body> BodySeq;
 typedef std::vector<Body>::const_iterator BodySeqCIter;
 
+// State the tick loop reads every frame. A snake in a World keeps it in its
+// World slot, see SnakeSlot, so a frame without a rotation or a move step is
+// decided from the dense slot array without touching the Snake object. A
+// snake out of a World keeps it in the object.
+struct SnakeTickState {
+  float angle = 0.0f;
+  float wangle = 0.0f;
+  long mov_ticks = 0;
+  long rot_ticks = 0;
+  // snake body part radius, in screen coords it is:
+  // - gsc * sbpr * 52 / 32 inner r, and
+  // - gsc * sbpr * 62 / 32 for outer r.
+  // thus, for sbpr 14.5, inner 21.20, outer 25.28
+  float sbpr = 0.0f;
+  // pixels / seconds, base ~185 [px/s]
+  uint16_t speed = 0;
+  uint8_t update = 0;
+  bool acceleration = false;
+  // sectors of the box in a player viewport, kept by the box and viewports
+  uint16_t observed = 0;
+
+  // adds dt to the frame timers if neither a rotation nor a move step is
+  // due, then Snake::Tick would have nothing else to do
+  inline bool Wait(long dt);
+};
+
+// Hot fields first: what Tick, Move and the collision checks touch every
+// frame, the cold block after it is read by the room when it sends packets.
 class Snake : public std::enable_shared_from_this<Snake> {
  public:
   typedef std::shared_ptr<Snake> Ptr;
 
-  snake_id_t id;
+  Snake() = default;
+  Snake(const Snake &) = delete;
+  Snake &operator=(const Snake &) = delete;
 
-  uint8_t skin;
-  uint8_t update;
-  bool acceleration;
+  snake_id_t id;
   bool bot;
 
-  std::string name;
-
-  // pixels / seconds, base ~185 [px/s]
-  uint16_t speed;
+  // own_state, or the World slot of the snake
+  SnakeTickState *state = &own_state;
 
-  float angle;
-  float wangle;
+  BodySeq parts;
+  SnakeBoundBox sbb;
 
   // 0 - 100, 0 - hungry, 100 - full
   uint16_t fullness;
 
-  SnakeBoundBox sbb;
+  // cold
+  uint8_t skin;
+  std::string name;
   ViewPort vp;
-  BodySeq parts;
   FoodSeq eaten;
   FoodSeq spawn;
   size_t clientPartsIndex;
 
-  bool Tick(long dt, SectorSeq *ss);
-  void TickAI(long frames);
+  // index in World slots
+  uint32_t slot = 0;
+  SnakeTickState own_state;
+
+  // coarse tick is for bots no one observes: missed steps are caught up
+  // with body moves only, sectors and food are refreshed once per batch
+  bool Tick(long dt, SectorSeq *ss, bool coarse);
+  void Move(float move_dist, SectorSeq *ss, bool tail_sectors);
   void UpdateBoxCenter();
   void UpdateBoxRadius();
   void UpdateSnakeConsts();
@@ -89,7 +123,7 @@ class Snake : public std::enable_shared_from_this<Snake> {
   void DecreaseSnake(uint16_t volume);
   void SpawnFood(Food f);
 
-  void on_dead_food_spawn(SectorSeq *ss, std::function<float()> next_randomf);
+  void on_dead_food_spawn(SectorSeq *ss, Random *rng);
   void on_food_eaten(Food f);
 
   float get_snake_scale() const;
@@ -124,12 +158,7 @@ class Snake : public std::enable_shared_from_this<Snake> {
   static constexpr float rot_step_angle = 1.0f * WorldConfig::move_step_distance /
     boost_speed * snake_angular_speed;  // radians step per max acc resolution time
   static const long rot_step_interval = static_cast<long>(1000.0f * rot_step_angle / snake_angular_speed);
-  static const long ai_step_interval = 1000;
-
- private:
-  long mov_ticks = 0;
-  long rot_ticks = 0;
-  long ai_ticks = 0;
+  static const long ai_step_interval = 250;  // bot decision period, see BotController
 
  private:
   float gsc = 0.0f;  // snake scale 0.5f + 0.4f / fmaxf(1.0f, 1.0f * (parts.size() - 1 + 16) / 36.0f)
@@ -137,14 +166,40 @@ class Snake : public std::enable_shared_from_this<Snake> {
   float scang = 0.0f;  // .13 + .87 * Math.pow((7 - f.sc) / 6, 2)
   float ssp = 0.0f;    // nsp1 + nsp2 * f.sc;
   float fsp = 0.0f;    // f.ssp + .1;
-  // snake body part radius, in screen coords it is:
-  // - gsc * sbpr * 52 / 32 inner r, and
-  // - gsc * sbpr * 62 / 32 for outer r.
-  // thus, for sbpr 14.5, inner 21.20, outer 25.28
-  float sbpr = 0.0f;
+};
+
+bool SnakeTickState::Wait(long dt) {
+  if (update & (change_dying | change_dead)) {
+    return true;
+  }
+
+  const bool rotate = angle != wangle;
+  if ((rotate && rot_ticks + dt >= Snake::rot_step_interval) ||
+      mov_ticks + dt >= 1000 * WorldConfig::move_step_distance / speed) {
+    return false;
+  }
+
+  if (rotate) {
+    rot_ticks += dt;
+  }
+  mov_ticks += dt;
+  return true;
+}
+
+// Tick state of a snake. World keeps them in a dense array the tick loop
+// walks, Snake::state points to the slot state while the snake is in the
+// World. A snake waiting for its next step or coarse batch costs the slot
+// only.
+struct SnakeSlot {
+  Snake *snake;
+  SnakeTickState state;
+  // time accumulated while ticked in coarse batches
+  long lod_ticks;
+  bool bot;
 };
 
 typedef std::vector<Snake *> SnakeVec;
+typedef std::vector<SnakeSlot> SnakeSlotVec;
 typedef std::unordered_map<snake_id_t, std::shared_ptr<Snake>> SnakeMap;
 typedef SnakeMap::iterator SnakeMapIter;
 typedef std::vector<snake_id_t> Ids;
@@ -0,0 +1,215 @@
+#include "game/snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "game/world.h"
+
+static const char snapshot_magic[] = {'S', 'L', 'S', 0};
+static const uint32_t snapshot_version = 2;
+
+// the layout is part of the format
+static_assert(sizeof(SnapshotHeader) == 48, "snapshot header layout");
+static_assert(sizeof(SnapshotSnake) == 24, "snapshot snake layout");
+static_assert(sizeof(SectorFood) == 4, "snapshot food layout");
+static_assert(sizeof(Body) == 8, "snapshot body layout");
+
+static size_t GetFoodIndexOffset() { return sizeof(SnapshotHeader); }
+
+static size_t GetFoodOffset(const SnapshotHeader &h) {
+  return GetFoodIndexOffset() + (h.sector_count + 1) * sizeof(uint32_t);
+}
+
+static size_t GetSnakesOffset(const SnapshotHeader &h) {
+  return GetFoodOffset(h) + h.food_count * sizeof(SectorFood);
+}
+
+static size_t GetPartsOffset(const SnapshotHeader &h) {
+  return GetSnakesOffset(h) + h.snake_count * sizeof(SnapshotSnake);
+}
+
+static size_t GetFileSize(const SnapshotHeader &h) {
+  return GetPartsOffset(h) + h.part_count * sizeof(Body);
+}
+
+template <typename T>
+static void WriteArray(std::ofstream *out, const std::vector<T> &v) {
+  out->write(reinterpret_cast<const char *>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+bool WriteSnapshot(World *world, const std::string &path) {
+  SectorSeq &sectors = world->GetSectors();
+
+  SnapshotHeader h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, snapshot_magic, sizeof(h.magic));
+  h.version = snapshot_version;
+  h.seed = world->GetSeed();
+  world->GetRandom().GetState(h.rng);
+  h.sector_count = static_cast<uint32_t>(sectors.size());
+  h.last_snake_id = world->GetLastSnakeId();
+
+  const FoodArena &arena = sectors.get_food_arena();
+  const SectorFood *items = arena.get_items();
+  std::vector<uint32_t> food_index;
+  food_index.reserve(sectors.size() + 1);
+  std::vector<SectorFood> food;
+  food.reserve(arena.get_size());
+  for (const FoodArena::Run &run : arena.get_runs()) {
+    food_index.push_back(static_cast<uint32_t>(food.size()));
+    food.insert(food.end(), items + run.offset, items + run.offset + run.count);
+  }
+  food_index.push_back(static_cast<uint32_t>(food.size()));
+
+  std::vector<SnapshotSnake> snakes;
+  std::vector<Body> parts;
+  for (const auto &pair : world->GetSnakes()) {
+    const Snake *s = pair.second.get();
+    if (!s->bot || (s->state->update & (change_dying | change_dead))) {
+      continue;
+    }
+
+    SnapshotSnake r;
+    std::memset(&r, 0, sizeof(r));
+    r.id = s->id;
+    r.skin = s->skin;
+    r.acceleration = s->state->acceleration ? 1 : 0;
+    r.speed = s->state->speed;
+    r.fullness = s->fullness;
+    r.angle = s->state->angle;
+    r.wangle = s->state->wangle;
+    r.part_begin = static_cast<uint32_t>(parts.size());
+    r.part_count = static_cast<uint32_t>(s->parts.size());
+    snakes.push_back(r);
+    parts.insert(parts.end(), s->parts.begin(), s->parts.end());
+  }
+
+  h.food_count = static_cast<uint32_t>(food.size());
+  h.snake_count = static_cast<uint32_t>(snakes.size());
+  h.part_count = static_cast<uint32_t>(parts.size());
+
+  const std::string tmp = path + ".tmp";
+  std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    return false;
+  }
+
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  WriteArray(&out, food_index);
+  WriteArray(&out, food);
+  WriteArray(&out, snakes);
+  WriteArray(&out, parts);
+  out.close();
+
+  if (!out) {
+    std::remove(tmp.c_str());
+    return false;
+  }
+
+  return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+SnapshotFile::~SnapshotFile() { Close(); }
+
+bool SnapshotFile::Open(const std::string &path) {
+  Close();
+
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+    close(fd);
+    return false;
+  }
+
+  void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    return false;
+  }
+
+  data = static_cast<const uint8_t *>(p);
+  size = static_cast<size_t>(st.st_size);
+
+  if (!Validate()) {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void SnapshotFile::Close() {
+  if (data != nullptr) {
+    munmap(const_cast<uint8_t *>(data), size);
+    data = nullptr;
+    size = 0;
+  }
+}
+
+bool SnapshotFile::Validate() const {
+  const SnapshotHeader &h = GetHeader();
+  if (std::memcmp(h.magic, snapshot_magic, sizeof(h.magic)) != 0 || h.version != snapshot_version ||
+      h.sector_count != WorldConfig::sector_count_along_edge * WorldConfig::sector_count_along_edge ||
+      size != GetFileSize(h)) {
+    return false;
+  }
+
+  const uint32_t *index = GetFoodIndex();
+  for (uint32_t i = 0; i < h.sector_count; i++) {
+    if (index[i] > index[i + 1]) {
+      return false;
+    }
+  }
+  if (index[0] != 0 || index[h.sector_count] != h.food_count) {
+    return false;
+  }
+
+  const SnapshotSnake *snakes = GetSnakes();
+  for (uint32_t i = 0; i < h.snake_count; i++) {
+    const SnapshotSnake &s = snakes[i];
+    if (s.id == 0 || s.id > h.last_snake_id || s.part_count < 3 || s.part_begin > h.part_count ||
+        s.part_count > h.part_count - s.part_begin) {
+      return false;
+    }
+  }
+
+  // sector lookups of the restored snakes are not range checked
+  static const float edge = WorldConfig::sector_size * WorldConfig::sector_count_along_edge;
+  const Body *parts = GetParts();
+  for (uint32_t i = 0; i < h.part_count; i++) {
+    if (!(parts[i].x >= 0.0f && parts[i].x < edge && parts[i].y >= 0.0f && parts[i].y < edge)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+const SnapshotHeader &SnapshotFile::GetHeader() const { return *reinterpret_cast<const SnapshotHeader *>(data); }
+
+const uint32_t *SnapshotFile::GetFoodIndex() const {
+  return reinterpret_cast<const uint32_t *>(data + GetFoodIndexOffset());
+}
+
+const SectorFood *SnapshotFile::GetFood() const {
+  return reinterpret_cast<const SectorFood *>(data + GetFoodOffset(GetHeader()));
+}
+
+const SnapshotSnake *SnapshotFile::GetSnakes() const {
+  return reinterpret_cast<const SnapshotSnake *>(data + GetSnakesOffset(GetHeader()));
+}
+
+const Body *SnapshotFile::GetParts() const {
+  return reinterpret_cast<const Body *>(data + GetPartsOffset(GetHeader()));
+}
@@ -0,0 +1,77 @@
+#ifndef SRC_GAME_SNAPSHOT_H_
+#define SRC_GAME_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "game/food.h"
+#include "game/snake.h"
+
+class World;
+
+// World snapshot: the food of every sector, bot snakes and the random
+// generator state. The file is a header followed by fixed layout arrays, in
+// host byte order, and is used right from a read only mapping - food and body
+// parts are bulk copied into the world, nothing is parsed. Players are not
+// saved, they reconnect.
+//
+// header
+// uint32_t food_index[sector_count + 1]  - sector i food is [index[i], index[i + 1])
+// SectorFood food[food_count]            - relative to their sectors
+// SnapshotSnake snakes[snake_count]
+// Body     parts[part_count]
+struct SnapshotHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t seed;
+  uint32_t rng[4];
+  uint32_t sector_count;
+  uint32_t food_count;
+  uint32_t snake_count;
+  uint32_t part_count;
+  uint16_t last_snake_id;
+  uint16_t reserved;
+};
+
+struct SnapshotSnake {
+  snake_id_t id;
+  uint8_t skin;
+  uint8_t acceleration;
+  uint16_t speed;
+  uint16_t fullness;
+  float angle;
+  float wangle;
+  uint32_t part_begin;
+  uint32_t part_count;
+};
+
+// Write to a temporary file and rename, so a crash never leaves a torn one.
+bool WriteSnapshot(World *world, const std::string &path);
+
+// Read only mapping of a snapshot file with validated layout.
+class SnapshotFile {
+ public:
+  SnapshotFile() = default;
+  SnapshotFile(const SnapshotFile &) = delete;
+  SnapshotFile &operator=(const SnapshotFile &) = delete;
+  ~SnapshotFile();
+
+  // false if there is no file, or it is not a compatible snapshot
+  bool Open(const std::string &path);
+  void Close();
+
+  const SnapshotHeader &GetHeader() const;
+  const uint32_t *GetFoodIndex() const;
+  const SectorFood *GetFood() const;
+  const SnapshotSnake *GetSnakes() const;
+  const Body *GetParts() const;
+
+ private:
+  bool Validate() const;
+
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+};
+
+#endif  // SRC_GAME_SNAPSHOT_H_
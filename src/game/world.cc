@@ -1,27 +1,41 @@
 #include "game/world.h"
 
 #include <algorithm>
+#include <chrono>
 #include <ctime>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include "game/math.h"
 
-Snake::Ptr World::CreateSnake() {
+World::~World() {
+  for (SnakeSlot &slot : slots) {
+    slot.snake->own_state = slot.state;
+    slot.snake->state = &slot.snake->own_state;
+  }
+}
+
+Snake::Ptr World::CreateSnake(bool bot) {
   lastSnakeId++;
 
   auto s = std::make_shared<Snake>();
   s->id = lastSnakeId;
+  s->bot = bot;
   s->name = "";
   s->skin = static_cast<uint8_t>(9 + NextRandom(21 - 9 + 1));
-  s->speed = Snake::base_move_speed;
+  s->state->speed = Snake::base_move_speed;
   s->fullness = 0;
 
   float angle = Math::f_2pi * NextRandomf();
   float dist = 1000.0f + NextRandom(5000);
-  uint16_t x = static_cast<uint16_t>(WorldConfig::game_radius + dist * cosf(angle));
-  uint16_t y = static_cast<uint16_t>(WorldConfig::game_radius + dist * sinf(angle));
+  float dir_sin, dir_cos;
+  Math::sin_cos(angle, &dir_sin, &dir_cos);
+  WorldConfig::coord_t x = static_cast<WorldConfig::coord_t>(WorldConfig::game_radius + dist * dir_cos);
+  WorldConfig::coord_t y = static_cast<WorldConfig::coord_t>(WorldConfig::game_radius + dist * dir_sin);
+  // the body goes out from the spawn point, back to the center
   angle = Math::normalize_angle(angle + Math::f_pi);
+  Math::sin_cos(angle, &dir_sin, &dir_cos);
   // const uint16_t half_radius = game_radius / 2;
   // uint16_t x = game_radius + NextRandom(game_radius) - half_radius;
   // uint16_t y = game_radius + NextRandom(game_radius) - half_radius;
@@ -32,51 +46,102 @@ Snake::Ptr World::CreateSnake() {
 
   for (int i = 0; i < len && i < Snake::parts_skip_count + Snake::parts_start_move_count; ++i) {
     s->parts.push_back(Body{1.0f * x, 1.0f * y});
-    x += cosf(angle) * WorldConfig::move_step_distance;
-    y += sinf(angle) * WorldConfig::move_step_distance;
+    x += dir_cos * WorldConfig::move_step_distance;
+    y += dir_sin * WorldConfig::move_step_distance;
   }
 
   for (int i = Snake::parts_skip_count + Snake::parts_start_move_count; i < len; ++i) {
     s->parts.push_back(Body{1.0f * x, 1.0f * y});
-    x += cosf(angle) * Snake::tail_step_distance;
-    y += sinf(angle) * Snake::tail_step_distance;
+    x += dir_cos * Snake::tail_step_distance;
+    y += dir_sin * Snake::tail_step_distance;
   }
 
-  s->clientPartsIndex = s->parts.size();
-  s->angle = Math::normalize_angle(angle + Math::f_pi);
-  s->wangle = Math::normalize_angle(angle + Math::f_pi);
+  s->state->angle = Math::normalize_angle(angle + Math::f_pi);
+  s->state->wangle = Math::normalize_angle(angle + Math::f_pi);
+  PlaceSnake(s.get());
 
+  return s;
+}
+
+void World::PlaceSnake(Snake *s) {
+  s->clientPartsIndex = s->parts.size();
   s->sbb = SnakeBoundBox(s->get_new_box());
   s->vp = ViewPort(s->get_new_box());
   s->UpdateBoxCenter();
   s->UpdateBoxRadius();
   s->UpdateSnakeConsts();
   s->InitBoxNewSectors(&sectors);
+}
 
-  return s;
+void World::RestoreSnake(const SnapshotSnake &r, const Body *parts) {
+  auto s = std::make_shared<Snake>();
+  s->id = r.id;
+  s->bot = true;
+  s->name = "";
+  s->skin = r.skin;
+  s->state->update = 0;
+  s->state->acceleration = r.acceleration != 0;
+  s->state->speed = r.speed;
+  s->fullness = r.fullness;
+  s->state->angle = r.angle;
+  s->state->wangle = r.wangle;
+  s->parts.assign(parts + r.part_begin, parts + r.part_begin + r.part_count);
+  PlaceSnake(s.get());
+
+  AddSnake(s);
 }
 
 Snake::Ptr World::CreateSnakeBot() {
-  Snake::Ptr ptr = CreateSnake();
-  ptr->bot = true;
-  return ptr;
+  return CreateSnake(true);
 }
 
-void World::InitRandom() { std::srand(std::time(nullptr)); }
+void World::InitRandom() {
+  if (config.seed == 0) {
+    config.seed = static_cast<uint32_t>(std::time(nullptr));
+  }
+  rng.Seed(config.seed);
+  rng_streams = 0;
+}
 
-int World::NextRandom() { return std::rand(); }
+uint32_t World::GetSeed() const { return config.seed; }
 
-float World::NextRandomf() { return 1.0f * std::rand() / RAND_MAX; }
+snake_id_t World::GetLastSnakeId() const { return lastSnakeId; }
+
+uint32_t World::NextRandom() { return rng.Next(); }
+
+float World::NextRandomf() { return rng.NextFloat(); }
 
 template <typename T>
 T World::NextRandom(T base) {
-  return static_cast<T>(NextRandom() % base);
+  return static_cast<T>(rng.Next(base));
+}
+
+Random &World::GetRandom() { return rng; }
+
+Random World::CreateRandomStream() {
+  // the world generator is stream 0
+  Random stream(config.seed);
+  rng_streams++;
+  for (uint16_t i = 0; i < rng_streams; i++) {
+    stream.Jump();
+  }
+  return stream;
 }
 
 void World::Tick(long dt) {
+  tick_stats = TickStats();
+  ApplyInputs();
+
+  // no food pointers are held between ticks
+  FoodArena &food = sectors.get_food_arena();
+  if (food.IsSparse()) {
+    food.Compact();
+  }
+
   ticks += dt;
   const long vfr = ticks / WorldConfig::frame_time_ms;
   if (vfr > 0) {
+    tick_stats.frames = vfr;
     const long vfr_time = vfr * WorldConfig::frame_time_ms;
     TickSnakes(vfr_time);
 
@@ -85,31 +150,112 @@ void World::Tick(long dt) {
   }
 }
 
+bool World::InputAngle(snake_id_t id, uint8_t angle) {
+  SnakeInput &in = GetInput(id);
+  in.angle = angle;
+  in.flags |= input_angle;
+  return in.count <= max_inputs_per_tick;
+}
+
+bool World::InputBoost(snake_id_t id, bool on) {
+  SnakeInput &in = GetInput(id);
+  in.flags |= input_boost;
+  if (on) {
+    in.flags |= input_boost_on;
+  } else {
+    in.flags &= ~input_boost_on;
+  }
+  return in.count <= max_inputs_per_tick;
+}
+
+// counts the input, the count saturates
+SnakeInput &World::GetInput(snake_id_t id) {
+  SnakeInput &in = inputs[id];
+  if (in.count == 0) {
+    pending.push_back(id);
+  }
+  if (in.count < std::numeric_limits<uint8_t>::max()) {
+    in.count++;
+  }
+  return in;
+}
+
+void World::ApplyInputs() {
+  for (const snake_id_t id : pending) {
+    SnakeInput &in = inputs[id];
+    const auto snake_i = snakes.find(id);
+    if (snake_i != snakes.end()) {
+      Snake *const s = snake_i->second.get();
+      if (in.flags & input_angle) {
+        s->state->wangle = Math::f_pi * in.angle / 125.0f;
+        s->state->update |= change_wangle;
+      }
+      if (in.flags & input_boost) {
+        s->state->acceleration = (in.flags & input_boost_on) != 0;
+      }
+    }
+    in = SnakeInput();
+  }
+  pending.clear();
+}
+
 void World::TickSnakes(long dt) {
-  for (auto pair : snakes) {
-    Snake *const s = pair.second.get();
+  using std::chrono::steady_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  const auto start = steady_clock::now();
+  ai.Tick(dt, &sectors);
+  const auto ai_end = steady_clock::now();
+
+  unseen = 0;
+  for (SnakeSlot &slot : slots) {
+    // bots out of every viewport run at reduced step rate
+    slot.lod_ticks += dt;
+    const bool coarse = slot.bot && config.bot_lod_interval > 0 && slot.state.observed == 0;
+    if (coarse) {
+      unseen++;
+      if (slot.lod_ticks < config.bot_lod_interval) {
+        continue;
+      }
+    }
 
-    if (s->Tick(dt, &sectors)) {
+    const long snake_dt = slot.lod_ticks;
+    slot.lod_ticks = 0;
+    if (slot.state.Wait(snake_dt)) {
+      continue;
+    }
+
+    Snake *const s = slot.snake;
+    if (s->Tick(snake_dt, &sectors, coarse)) {
       changes.push_back(s);
     }
   }
+  const auto snakes_end = steady_clock::now();
 
   for (auto s : changes) {
-    if (s->update & change_pos) {
+    if (s->state->update & change_pos) {
       CheckSnakeBounds(s);
     }
   }
+
+  tick_stats.ai_ns = duration_cast<nanoseconds>(ai_end - start).count();
+  tick_stats.snakes_ns = duration_cast<nanoseconds>(snakes_end - ai_end).count();
+  tick_stats.bounds_ns = duration_cast<nanoseconds>(steady_clock::now() - snakes_end).count();
 }
 
 void World::CheckSnakeBounds(Snake *s) {
-  static std::vector<snake_id_t> cs_cache;
-  cs_cache.clear();
+  if (++bounds_epoch == 0) {
+    // stamps wrapped around, forget all of them
+    std::fill(bounds_visits.begin(), bounds_visits.end(), 0);
+    bounds_epoch = 1;
+  }
 
   // world bounds
   const Body &head = s->get_head();
   if (head.DistanceSquared(WorldConfig::game_radius, WorldConfig::game_radius) >=
       WorldConfig::death_radius * WorldConfig::death_radius) {
-    s->update |= change_dying;
+    s->state->update |= change_dying;
     return;
   }
 
@@ -140,14 +286,20 @@ void World::CheckSnakeBounds(Snake *s) {
             }
 
             // check if snakes already checked
-            if (std::find(cs_cache.begin(), cs_cache.end(), s2->id) != cs_cache.end()) {
+            uint16_t &visit = bounds_visits[s2->id];
+            if (visit == bounds_epoch) {
+              continue;
+            }
+            visit = bounds_epoch;
+
+            // whole body circle first, parts are within its radius
+            const float reach = bb_ptr->r + check.r + s2->get_snake_body_part_radius();
+            if (!Math::intersect_circle(bb_ptr->x, bb_ptr->y, check.x, check.y, reach)) {
               continue;
-            } else {
-              cs_cache.push_back(s2->id);
             }
 
             if (s2->Intersect(check)) {
-              s->update |= change_dying;
+              s->state->update |= change_dying;
               return;
             }
           }
@@ -166,30 +318,55 @@ void World::Init(WorldConfig in_config) {
 
   InitRandom();
   InitSectors();
+  ai.Init(config);
+  bounds_visits.assign(bounds_visit_slots, 0);
+  inputs.assign(bounds_visit_slots, SnakeInput());
   InitFood();
 
   SpawnNumSnakes(in_config.bots);
 }
 
+void World::Init(WorldConfig in_config, const SnapshotFile &snapshot) {
+  const SnapshotHeader &h = snapshot.GetHeader();
+
+  config = in_config;
+  config.seed = h.seed;
+
+  InitRandom();
+  rng.SetState(h.rng);
+  InitSectors();
+  ai.Init(config);
+  bounds_visits.assign(bounds_visit_slots, 0);
+  inputs.assign(bounds_visit_slots, SnakeInput());
+
+  sectors.get_food_arena().Load(snapshot.GetFood(), snapshot.GetFoodIndex());
+
+  lastSnakeId = h.last_snake_id;
+  const SnapshotSnake *records = snapshot.GetSnakes();
+  for (uint32_t i = 0; i < h.snake_count; i++) {
+    RestoreSnake(records[i], snapshot.GetParts());
+  }
+}
+
 void World::InitSectors() {
   sectors.InitSectors();
 }
 
 void World::InitFood() {
   for (Sector &s : sectors) {
-    const uint8_t cx = WorldConfig::sector_count_along_edge / 2;
-    const uint8_t cy = cx;
-    const uint16_t dist = (s.x - cx) * (s.x - cx) + (s.y - cy) * (s.y - cy);
+    const Sector::index_t cx = WorldConfig::sector_count_along_edge / 2;
+    const Sector::index_t cy = cx;
+    const uint32_t dist = (s.x - cx) * (s.x - cx) + (s.y - cy) * (s.y - cy);
     const float dp = 1.0f -
                      1.0f * dist / (WorldConfig::sector_count_along_edge *
                                     WorldConfig::sector_count_along_edge);
     const size_t density = static_cast<size_t>(dp * 10);
     for (size_t i = 0; i < density; i++) {
       s.Insert(
-          Food{static_cast<uint16_t>(
+          Food{static_cast<Food::coord_t>(
                    s.x * WorldConfig::sector_size +
                        NextRandom<uint16_t>(WorldConfig::sector_size)),
-               static_cast<uint16_t>(
+               static_cast<Food::coord_t>(
                    s.y * WorldConfig::sector_size +
                        NextRandom<uint16_t>(WorldConfig::sector_size)),
                static_cast<uint8_t>(1 + NextRandom<uint8_t>(10)),
@@ -197,10 +374,22 @@ void World::InitFood() {
     }
     s.Sort();
   }
+
+  // runs grew one by one, lay them out with slack
+  sectors.get_food_arena().Compact();
 }
 
 void World::AddSnake(Snake::Ptr ptr) {
   snakes.insert({ptr->id, ptr});
+  ptr->slot = static_cast<uint32_t>(slots.size());
+
+  const SnakeSlot *const data = slots.data();
+  slots.push_back(SnakeSlot{ptr.get(), *ptr->state, 0, ptr->bot});
+  BindSlots(slots.data() == data ? ptr->slot : 0, slots.size());
+
+  if (ptr->bot) {
+    ai.Add(ptr.get());
+  }
 }
 
 void World::RemoveSnake(snake_id_t id) {
@@ -208,14 +397,36 @@ void World::RemoveSnake(snake_id_t id) {
 
   auto sn_i = GetSnake(id);
   if (sn_i != snakes.end()) {
-    for (auto sec_ptr : sn_i->second->sbb.sectors) {
-      sec_ptr->RemoveSnake(id);
+    sn_i->second->sbb.LeaveAll();
+
+    sn_i->second->vp.Clear(&sectors);
+
+    // the snake takes its state back, the last slot takes the place
+    Snake *const s = sn_i->second.get();
+    const uint32_t slot = s->slot;
+    s->own_state = slots[slot].state;
+    s->state = &s->own_state;
+    slots[slot] = slots.back();
+    slots.pop_back();
+    if (slot < slots.size()) {
+      slots[slot].snake->slot = slot;
+      BindSlots(slot, slot + 1);
+    }
+
+    if (sn_i->second->bot) {
+      ai.Remove(id);
     }
 
     snakes.erase(id);
   }
 }
 
+void World::BindSlots(size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    slots[i].snake->state = &slots[i].state;
+  }
+}
+
 SnakeMapIter World::GetSnake(snake_id_t id) {
   return snakes.find(id);
 }
@@ -224,6 +435,12 @@ SnakeMap &World::GetSnakes() { return snakes; }
 
 Ids &World::GetDead() { return dead; }
 
+BotStats &World::GetBotStats() { return ai.GetStats(); }
+
+size_t World::GetUnseenCount() { return unseen; }
+
+const TickStats &World::GetTickStats() const { return tick_stats; }
+
 std::vector<Snake *> &World::GetChangedSnakes() { return changes; }
 
 void World::FlushChanges() { changes.clear(); }
@@ -261,5 +478,6 @@ std::ostream &operator<<(std::ostream &out, const World &w) {
              << "\n\tparts_skip_count = " << Snake::parts_skip_count
              << "\n\tparts_start_move_count = " << Snake::parts_start_move_count
              << "\n\tmove_step_distance = " << WorldConfig::move_step_distance
-             << "\n\trot_step_angle = " << Snake::rot_step_angle;
+             << "\n\trot_step_angle = " << Snake::rot_step_angle
+             << "\n\tai_step_interval = " << Snake::ai_step_interval;
 }
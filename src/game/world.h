@@ -6,27 +6,73 @@
 #include <vector>
 #include <unordered_map>
 
+#include "game/bot.h"
+#include "game/random.h"
 #include "game/sector.h"
 #include "game/snake.h"
+#include "game/snapshot.h"
+
+// time spent in the phases of the last Tick
+struct TickStats {
+  long frames = 0;  // virtual frames simulated, 0 - nothing was done
+  uint64_t ai_ns = 0;
+  uint64_t snakes_ns = 0;
+  uint64_t bounds_ns = 0;
+};
+
+enum input_flags : uint8_t {
+  input_angle = 1,
+  input_boost = 1 << 1,     // boost was switched
+  input_boost_on = 1 << 2,  // to on
+};
+
+// Client input of a snake buffered until the next tick. The last angle wins,
+// boost latches at the last switch.
+struct SnakeInput {
+  uint8_t angle = 0;  // [0 - 250]
+  uint8_t flags = 0;
+  uint8_t count = 0;  // since the last tick
+};
 
 class World {
  public:
+  World() = default;
+  // snakes outliving the world get their state back
+  ~World();
+  World(const World &) = delete;
+  World &operator=(const World &) = delete;
+
   void Init(WorldConfig in_config);
+  // the snapshot replaces food, bots and the random state Init would create
+  void Init(WorldConfig in_config, const SnapshotFile &snapshot);
   void InitSectors();
   void InitFood();
 
   void Tick(long dt);
 
-  Snake::Ptr CreateSnake();
+  // player input, applied at the start of the next Tick. The slot is always
+  // overwritten, false only tells the snake sent over max_inputs_per_tick
+  // inputs since the last tick.
+  bool InputAngle(snake_id_t id, uint8_t angle);
+  bool InputBoost(snake_id_t id, bool on);
+
+  Snake::Ptr CreateSnake(bool bot = false);
   Snake::Ptr CreateSnakeBot();
+  // boxes, consts and sectors of a snake with its body set
+  void PlaceSnake(Snake *s);
   void SpawnNumSnakes(const int count);
   void CheckSnakeBounds(Snake *s);
 
   void InitRandom();
-  int NextRandom();
+  uint32_t GetSeed() const;
+  snake_id_t GetLastSnakeId() const;
+  uint32_t NextRandom();
   float NextRandomf();
   template <typename T>
   T NextRandom(T base);
+  Random& GetRandom();
+  // independent generator for another thread, deterministic for the seed
+  Random CreateRandomStream();
 
   void AddSnake(Snake::Ptr ptr);
   void RemoveSnake(snake_id_t id);
@@ -34,6 +80,9 @@ class World {
   SnakeMap& GetSnakes();
   SectorSeq& GetSectors();
   Ids& GetDead();
+  BotStats& GetBotStats();
+  size_t GetUnseenCount();
+  const TickStats& GetTickStats() const;
 
   SnakeVec& GetChangedSnakes();
 
@@ -43,23 +92,48 @@ class World {
   void FlushChanges();
 
  private:
+  void ApplyInputs();
+  SnakeInput &GetInput(snake_id_t id);
   void TickSnakes(long dt);
+  void RestoreSnake(const SnapshotSnake &r, const Body *parts);
+  // points the snakes of the slots to their slot state, after slots moved
+  void BindSlots(size_t begin, size_t end);
 
  private:
   // TODO(john.koepi): reserve to collections
   SnakeMap snakes;
+  // tick order, dense, Snake::slot indexes it, Snake::state points to it
+  SnakeSlotVec slots;
   Ids dead;
   SectorSeq sectors;
   SnakeVec changes;
+  BotController ai;
 
   // TODO(john.koepi) pools
   // TODO(john.koepi) sorted checker
 
   // TODO(john.koepi) manage overflow, reuse old?
   uint16_t lastSnakeId = 0;
+  Random rng;
+  uint16_t rng_streams = 0;
   long ticks = 0;
   uint32_t frames = 0;
 
+  // CheckSnakeBounds visit stamps by snake id: a snake over several of the
+  // checked sectors is tested once. Owned by the world, not shared with
+  // worlds ticking on other threads.
+  std::vector<uint16_t> bounds_visits;
+  uint16_t bounds_epoch = 0;
+  static const size_t bounds_visit_slots = 1 << (8 * sizeof(snake_id_t));
+
+  // buffered input by snake id, pending lists the ids with some
+  std::vector<SnakeInput> inputs;
+  Ids pending;
+  static const uint8_t max_inputs_per_tick = 4;
+
+  size_t unseen = 0;
+  TickStats tick_stats;
+
   WorldConfig config;
 };
 
@@ -0,0 +1,162 @@
+#include "loadgen/client.h"
+
+#include <algorithm>
+
+#include "game/config.h"
+#include "game/math.h"
+#include "packet/p_base.h"
+
+void LatencySample::Add(long v) {
+  count++;
+  sum += static_cast<uint64_t>(v);
+  max = std::max(max, v);
+}
+
+long LatencySample::Avg() const { return count > 0 ? static_cast<long>(sum / count) : 0; }
+
+void LatencySample::Reset() { *this = LatencySample(); }
+
+void LoadStats::Reset() {
+  const uint64_t c = connects, f = fails, cl = closes, d = deaths;
+  *this = LoadStats();
+  // connection counters are totals
+  connects = c;
+  fails = f;
+  closes = cl;
+  deaths = d;
+}
+
+Client::Client(client_profile_t in_profile, float in_angle) : profile(in_profile), angle(in_angle) {}
+
+bool Client::IsDead() const { return dead; }
+
+void Client::Tick(long now, const LoadConfig &config, std::mt19937 *rng, std::vector<std::string> *out) {
+  if (!hello) {
+    hello = true;
+
+    std::string p;
+    p.push_back(static_cast<char>(in_packet_t_username_skin));
+    p.push_back(static_cast<char>(WorldConfig::protocol_version));
+    p.push_back(static_cast<char>((*rng)() % 40));  // skin
+    p.append("loadgen");
+    out->push_back(p);
+
+    next_input = now + static_cast<long>((*rng)() % std::max<uint16_t>(1, config.input_interval));
+    next_ping = now;
+  }
+
+  if (ping_sent == 0 && now >= next_ping) {
+    out->push_back(std::string(1, static_cast<char>(in_packet_t_ping)));
+    ping_sent = now;
+    next_ping = now + config.ping_interval;
+  }
+
+  if (init && now >= next_input) {
+    Steer(now, rng, out);
+    next_input = now + config.input_interval;
+  }
+}
+
+void Client::Steer(long now, std::mt19937 *rng, std::vector<std::string> *out) {
+  std::uniform_real_distribution<float> turn(-0.8f, 0.8f);
+
+  switch (profile) {
+    case profile_wander:
+      angle += turn(*rng);
+      break;
+
+    case profile_circle:
+      angle += 0.3f;
+      break;
+
+    case profile_boost:
+      angle += turn(*rng);
+      if ((*rng)() % 10 == 0) {
+        boost = !boost;
+        out->push_back(std::string(1, static_cast<char>(boost ? in_packet_t_start_acc : in_packet_t_stop_acc)));
+      }
+      break;
+
+    default:
+      return;
+  }
+
+  angle = Math::normalize_angle(angle);
+
+  // in_packet_t_angle, [0 - 250]
+  const uint8_t a = static_cast<uint8_t>(angle * 125.0f / Math::f_pi) % 251;
+  out->push_back(std::string(1, static_cast<char>(a)));
+  input_sent = now;
+}
+
+void Client::OnMessage(const std::string &payload, long now, LoadStats *stats) {
+  const size_t len = payload.size();
+  bytes_in += len;
+  stats->messages_in++;
+  stats->bytes_in += len;
+
+  // 0-1 client time, 2 packet type
+  if (len < 3) {
+    return;
+  }
+
+  const uint8_t type = static_cast<uint8_t>(payload[2]);
+  stats->type_count[type]++;
+  stats->type_bytes[type] += len;
+
+  // 3-4 snake id, where present
+  const uint16_t id = len >= 5 ? static_cast<uint16_t>(static_cast<uint8_t>(payload[3]) << 8 |
+                                                       static_cast<uint8_t>(payload[4]))
+                               : 0;
+
+  switch (type) {
+    case packet_t_init:
+      init = true;
+      break;
+
+    case packet_t_snake:
+      // add snake is longer than remove snake (6 bytes)
+      if (init && snake_id == 0 && len > 6) {
+        snake_id = id;
+      }
+      break;
+
+    case packet_t_pong:
+      if (ping_sent > 0) {
+        stats->ping_rtt.Add(now - ping_sent);
+        ping_sent = 0;
+      }
+      break;
+
+    case packet_t_end:
+      dead = true;
+      stats->deaths++;
+      break;
+
+    case packet_t_mov:
+    case packet_t_mov_rel:
+    case packet_t_inc:
+    case packet_t_inc_rel:
+      if (id == snake_id && snake_id != 0) {
+        if (last_update > 0) {
+          stats->update_gap.Add(now - last_update);
+        }
+        last_update = now;
+      }
+      break;
+
+    case packet_t_rot_ccw_ang:
+    case packet_t_rot_ccw_wang:
+    case packet_t_rot_ccw_ang_wang:
+    case packet_t_rot_cw_wang:
+    case packet_t_rot_cw_ang_wang:
+      if (id == snake_id && input_sent > 0) {
+        stats->input_latency.Add(now - input_sent);
+        input_sent = 0;
+      }
+      break;
+
+    default:
+      break;
+  }
+}
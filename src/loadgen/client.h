@@ -0,0 +1,79 @@
+#ifndef SRC_LOADGEN_CLIENT_H_
+#define SRC_LOADGEN_CLIENT_H_
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "loadgen/config.h"
+
+struct LatencySample {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  long max = 0;
+
+  void Add(long v);
+  long Avg() const;
+  void Reset();
+};
+
+struct LoadStats {
+  uint64_t connects = 0;
+  uint64_t fails = 0;
+  uint64_t closes = 0;
+  uint64_t deaths = 0;
+
+  uint64_t messages_in = 0;
+  uint64_t bytes_in = 0;
+  uint64_t messages_out = 0;
+  uint64_t bytes_out = 0;
+
+  // inbound by out_packet_t
+  uint64_t type_count[256] = {};
+  uint64_t type_bytes[256] = {};
+
+  LatencySample ping_rtt;       // ping to pong
+  LatencySample input_latency;  // angle input to own snake rotation update
+  LatencySample update_gap;     // between own snake move updates
+
+  void Reset();
+};
+
+// Synthetic client state. Speaks the same input protocol the browser client
+// does and decodes only packet headers and the fields needed for latency
+// tracking.
+class Client {
+ public:
+  Client() = default;
+  Client(client_profile_t in_profile, float in_angle);
+
+  // appends packets to be sent by now into out
+  void Tick(long now, const LoadConfig &config, std::mt19937 *rng, std::vector<std::string> *out);
+  void OnMessage(const std::string &payload, long now, LoadStats *stats);
+
+  bool IsDead() const;
+
+  uint64_t bytes_in = 0;  // since last report
+
+ private:
+  void Steer(long now, std::mt19937 *rng, std::vector<std::string> *out);
+
+ private:
+  client_profile_t profile = profile_idle;
+  uint16_t snake_id = 0;  // own snake, first one added after init
+
+  bool hello = false;
+  bool init = false;
+  bool dead = false;
+  bool boost = false;
+
+  float angle = 0.0f;
+  long next_input = 0;
+  long next_ping = 0;
+  long ping_sent = 0;   // 0 - no ping in flight
+  long input_sent = 0;  // 0 - no input awaits rotation
+  long last_update = 0;
+};
+
+#endif  // SRC_LOADGEN_CLIENT_H_
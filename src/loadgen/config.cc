@@ -0,0 +1,74 @@
+#include "loadgen/config.h"
+
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+static bool ParseProfile(const std::string &name, client_profile_t *out) {
+  static const char *const names[] = {"idle", "wander", "circle", "boost", "mixed"};
+
+  for (uint8_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    if (name == names[i]) {
+      *out = static_cast<client_profile_t>(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+LoadConfig ParseCommandLine(const int argc, const char *const *argv) {
+  LoadConfig config;
+
+  po::options_description generic("Generic options");
+  generic.add_options()("help,h", po::bool_switch(&config.help),
+                        "print help message")(
+      "verbose,v", po::bool_switch(&config.verbose), "set verbose output")(
+      "host", po::value<std::string>(&config.host)->default_value(config.host),
+      "server host")(
+      "port,p", po::value<uint16_t>(&config.port)->default_value(config.port),
+      "server port");
+
+  po::options_description conf("Load");
+  conf.add_options()(
+      "clients,c", po::value<uint32_t>(&config.clients)->default_value(config.clients),
+      "number of concurrent clients")(
+      "rate,r", po::value<uint16_t>(&config.connect_rate)->default_value(config.connect_rate),
+      "new connections per second")(
+      "duration,t", po::value<uint32_t>(&config.duration)->default_value(config.duration),
+      "test duration in seconds, 0 - forever")(
+      "input", po::value<uint16_t>(&config.input_interval)->default_value(config.input_interval),
+      "interval between client inputs, ms")(
+      "ping", po::value<uint16_t>(&config.ping_interval)->default_value(config.ping_interval),
+      "interval between client pings, ms")(
+      "profile", po::value<std::string>(&config.profile)->default_value(config.profile),
+      "client behavior: idle, wander, circle, boost, mixed")(
+      "reconnect", po::bool_switch(&config.reconnect),
+      "replace dead clients with new connections");
+
+  po::options_description cmdline_options;
+  cmdline_options.add(generic).add(conf);
+
+  po::variables_map vm;
+
+  try {
+    po::store(po::parse_command_line(argc, argv, cmdline_options), vm);
+    po::notify(vm);
+  } catch (const po::error &e) {
+    std::cerr << "error: " << e.what() << '\n';
+    config.help = true;
+  }
+
+  if (!config.help && !ParseProfile(config.profile, &config.profile_type)) {
+    std::cerr << "error: unknown profile " << config.profile << '\n';
+    config.help = true;
+  }
+
+  if (config.help) {
+    std::cerr << "Usage: slither_loadgen [OPTIONS]\n";
+    std::cerr << cmdline_options << '\n';
+    exit(1);
+  }
+
+  return config;
+}
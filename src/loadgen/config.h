@@ -0,0 +1,42 @@
+#ifndef SRC_LOADGEN_CONFIG_H_
+#define SRC_LOADGEN_CONFIG_H_
+
+#include <cstdint>
+#include <string>
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+
+using websocketpp::log::alevel;
+using websocketpp::log::elevel;
+
+// client behavior, what inputs synthetic client sends
+enum client_profile_t : uint8_t {
+  profile_idle = 0,    // only pings
+  profile_wander = 1,  // random direction changes
+  profile_circle = 2,  // steady turning
+  profile_boost = 3,   // wander with acceleration bursts
+  profile_mixed = 4,   // all of above round robin over clients
+};
+
+struct LoadConfig {
+  std::string host = "127.0.0.1";
+  uint16_t port = 8080;
+
+  uint32_t clients = 100;
+  uint16_t connect_rate = 200;    // new connections per second
+  uint32_t duration = 0;          // seconds, 0 - run forever
+  uint16_t input_interval = 100;  // ms between inputs of a single client
+  uint16_t ping_interval = 250;   // ms, as the native client does
+
+  std::string profile = "mixed";
+  client_profile_t profile_type = profile_mixed;
+
+  bool reconnect = false;  // replace dead clients with new connections
+
+  bool help = false;
+  bool verbose = false;
+};
+
+LoadConfig ParseCommandLine(const int argc, const char *const *argv);
+
+#endif  // SRC_LOADGEN_CONFIG_H_
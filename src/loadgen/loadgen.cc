@@ -0,0 +1,223 @@
+#include "loadgen/loadgen.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#include "packet/p_base.h"
+
+using websocketpp::lib::placeholders::_1;
+using websocketpp::lib::placeholders::_2;
+using websocketpp::lib::bind;
+
+LoadGenerator::LoadGenerator() : rng(std::random_device()()) {
+  // thousands of connections, keep library logs quiet
+  endpoint.clear_access_channels(alevel::all);
+  endpoint.set_access_channels(alevel::app);
+  endpoint.clear_error_channels(elevel::all);
+  endpoint.set_error_channels(elevel::fatal);
+
+  endpoint.init_asio();
+
+  endpoint.set_open_handler(bind(&LoadGenerator::on_open, this, _1));
+  endpoint.set_fail_handler(bind(&LoadGenerator::on_fail, this, _1));
+  endpoint.set_close_handler(bind(&LoadGenerator::on_close, this, _1));
+  endpoint.set_message_handler(bind(&LoadGenerator::on_message, this, _1, _2));
+}
+
+int LoadGenerator::Run(LoadConfig in_config) {
+  config = in_config;
+  uri = "ws://" + config.host + ":" + std::to_string(config.port) + "/slither";
+
+  if (config.verbose) {
+    endpoint.set_error_channels(elevel::all);
+  }
+
+  endpoint.get_alog().write(alevel::app,
+      "Loading " + uri + " with " + std::to_string(config.clients) + " clients, profile " + config.profile);
+
+  start_time = GetCurrentTime();
+  last_report_time = start_time;
+  NextTick(start_time);
+
+  try {
+    endpoint.run();
+    return 0;
+  } catch (websocketpp::exception const &e) {
+    std::cout << e.what() << std::endl;
+    return 1;
+  }
+}
+
+void LoadGenerator::NextTick(long last) {
+  last_time_point = last;
+  timer = endpoint.set_timer(
+      std::max(0L, timer_interval_ms - (GetCurrentTime() - last)),
+      bind(&LoadGenerator::on_timer, this, _1));
+}
+
+void LoadGenerator::on_timer(error_code const &ec) {
+  const long now = GetCurrentTime();
+  const long dt = now - last_time_point;
+
+  if (ec) {
+    endpoint.get_alog().write(alevel::app, "Load timer error: " + ec.message());
+    return;
+  }
+
+  if (config.duration > 0 && now - start_time >= config.duration * 1000L) {
+    Report(now - last_report_time);
+    Stop();
+    return;
+  }
+
+  // ramp up to the target population at the configured rate
+  connect_credit = std::min(connect_credit + config.connect_rate * dt / 1000.0f,
+                            static_cast<float>(config.connect_rate));
+  while (connect_credit >= 1.0f && clients.size() + connecting < config.clients &&
+         (config.reconnect || started < config.clients)) {
+    Connect();
+    connect_credit -= 1.0f;
+  }
+
+  for (auto &c : clients) {
+    c.second.Tick(now, config, &rng, &outbox);
+    for (const std::string &p : outbox) {
+      Send(c.first, p);
+    }
+    outbox.clear();
+  }
+
+  if (now - last_report_time >= report_interval_ms) {
+    Report(now - last_report_time);
+    last_report_time = now;
+  }
+
+  NextTick(now);
+}
+
+void LoadGenerator::Connect() {
+  error_code ec;
+  WSPPClient::connection_ptr con = endpoint.get_connection(uri, ec);
+  if (ec) {
+    endpoint.get_alog().write(alevel::app, "Connection init error: " + ec.message());
+    stats.fails++;
+    return;
+  }
+
+  connecting++;
+  started++;
+  endpoint.connect(con);
+}
+
+void LoadGenerator::Send(connection_hdl hdl, const std::string &packet) {
+  error_code ec;
+  endpoint.send(hdl, packet.data(), packet.size(), opcode::binary, ec);
+  if (ec) {
+    return;
+  }
+
+  stats.messages_out++;
+  stats.bytes_out += packet.size();
+}
+
+void LoadGenerator::Stop() {
+  stopping = true;
+  for (auto &c : clients) {
+    error_code ec;
+    endpoint.close(c.first, websocketpp::close::status::going_away, "", ec);
+  }
+  endpoint.stop();
+}
+
+void LoadGenerator::on_open(connection_hdl hdl) {
+  connecting--;
+  stats.connects++;
+
+  client_profile_t profile = config.profile_type;
+  if (profile == profile_mixed) {
+    profile = static_cast<client_profile_t>(stats.connects % profile_mixed);
+  }
+
+  std::uniform_real_distribution<float> angle(0.0f, 6.28f);
+  clients[hdl] = Client(profile, angle(rng));
+}
+
+void LoadGenerator::on_fail(connection_hdl hdl) {
+  connecting--;
+  stats.fails++;
+
+  if (config.verbose) {
+    error_code ec;
+    WSPPClient::connection_ptr con = endpoint.get_con_from_hdl(hdl, ec);
+    if (!ec) {
+      endpoint.get_alog().write(alevel::app, "Connection failed: " + con->get_ec().message());
+    }
+  }
+}
+
+void LoadGenerator::on_close(connection_hdl hdl) {
+  if (clients.erase(hdl) > 0) {
+    stats.closes++;
+  }
+}
+
+void LoadGenerator::on_message(connection_hdl hdl, message_ptr ptr) {
+  const auto c = clients.find(hdl);
+  if (c == clients.end() || ptr->get_opcode() != opcode::binary) {
+    return;
+  }
+
+  c->second.OnMessage(ptr->get_payload(), GetCurrentTime(), &stats);
+
+  if (c->second.IsDead() && !stopping) {
+    error_code ec;
+    endpoint.close(hdl, websocketpp::close::status::normal, "dead", ec);
+  }
+}
+
+void LoadGenerator::Report(long interval) {
+  interval = std::max(1L, interval);
+
+  uint64_t max_client_bytes = 0;
+  for (auto &c : clients) {
+    max_client_bytes = std::max(max_client_bytes, c.second.bytes_in);
+    c.second.bytes_in = 0;
+  }
+
+  const size_t n = std::max<size_t>(1, clients.size());
+
+  std::stringstream s;
+  s << "Clients " << clients.size() << " (connecting " << connecting
+    << ", connects " << stats.connects << ", fails " << stats.fails
+    << ", closes " << stats.closes << ", deaths " << stats.deaths << ")"
+    << ", in " << stats.messages_in * 1000 / interval << " msg/s "
+    << stats.bytes_in / interval << " kB/s"
+    << ", out " << stats.messages_out * 1000 / interval << " msg/s "
+    << stats.bytes_out / interval << " kB/s"
+    << ", per client avg " << stats.bytes_in * 1000 / n / interval << " B/s"
+    << " max " << max_client_bytes * 1000 / interval << " B/s"
+    << ", ping rtt avg " << stats.ping_rtt.Avg() << "ms max " << stats.ping_rtt.max << "ms"
+    << ", input latency avg " << stats.input_latency.Avg() << "ms max " << stats.input_latency.max << "ms"
+    << ", update gap avg " << stats.update_gap.Avg() << "ms max " << stats.update_gap.max << "ms";
+
+  if (config.verbose) {
+    s << "\n  inbound by type:";
+    for (size_t i = 0; i < 256; i++) {
+      if (stats.type_count[i] > 0) {
+        s << " '" << static_cast<char>(i) << "' " << stats.type_count[i] << "/" << stats.type_bytes[i] << "B";
+      }
+    }
+  }
+
+  endpoint.get_alog().write(alevel::app, s.str());
+  stats.Reset();
+}
+
+long LoadGenerator::GetCurrentTime() {
+  using std::chrono::milliseconds;
+  using std::chrono::duration_cast;
+  using std::chrono::steady_clock;
+
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
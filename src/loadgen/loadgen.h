@@ -0,0 +1,73 @@
+#ifndef SRC_LOADGEN_LOADGEN_H_
+#define SRC_LOADGEN_LOADGEN_H_
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <websocketpp/client.hpp>
+
+#include "loadgen/client.h"
+#include "loadgen/config.h"
+
+typedef websocketpp::client<websocketpp::config::asio_client> WSPPClient;
+typedef websocketpp::connection_hdl connection_hdl;
+typedef websocketpp::frame::opcode::value opcode;
+typedef websocketpp::lib::error_code error_code;
+typedef WSPPClient::message_ptr message_ptr;
+
+// Opens a population of synthetic clients against a running server from a
+// single asio loop, drives their inputs and reports traffic and latency.
+class LoadGenerator {
+ public:
+  LoadGenerator();
+
+  int Run(LoadConfig in_config);
+
+  typedef std::map<connection_hdl, Client, std::owner_less<connection_hdl>> ClientMap;
+
+ private:
+  void on_open(connection_hdl hdl);
+  void on_fail(connection_hdl hdl);
+  void on_close(connection_hdl hdl);
+  void on_message(connection_hdl hdl, message_ptr ptr);
+  void on_timer(error_code const &ec);
+
+  void Connect();
+  void Send(connection_hdl hdl, const std::string &packet);
+  void Stop();
+
+  long GetCurrentTime();
+  void NextTick(long last);
+
+  void Report(long interval);
+
+ private:
+  WSPPClient endpoint;
+
+  WSPPClient::timer_ptr timer;
+  long last_time_point = 0;
+  static const long timer_interval_ms = 10;
+
+  long start_time = 0;
+  long last_report_time = 0;
+  static const long report_interval_ms = 1000;
+
+  LoadConfig config;
+  std::string uri;
+  std::mt19937 rng;
+
+  ClientMap clients;
+  LoadStats stats;
+
+  uint32_t connecting = 0;
+  uint32_t started = 0;
+  float connect_credit = 0.0f;
+  bool stopping = false;
+
+  std::vector<std::string> outbox;
+};
+
+#endif  // SRC_LOADGEN_LOADGEN_H_
@@ -0,0 +1,5 @@
+#include "loadgen/loadgen.h"
+
+int main(const int argc, const char* const argv[]) {
+  return std::unique_ptr<LoadGenerator>(new LoadGenerator())->Run(ParseCommandLine(argc, argv));
+}
@@ -2,8 +2,9 @@
 
 std::ostream& operator<<(std::ostream& out, const packet_set_food& p) {
   out << static_cast<PacketBase>(p);
-  for (const Food& f : *p.food_ptr) {
-    out << write_uint8(f.color) << write_uint16(f.x) << write_uint16(f.y)
+  for (const SectorFood& sf : p.sector_ptr->food) {
+    const Food f = p.sector_ptr->Unpack(sf);
+    out << write_uint8(f.color) << write_coord(f.x) << write_coord(f.y)
         << write_uint8(f.size * 5);
   }
   return out;
@@ -11,21 +12,21 @@ std::ostream& operator<<(std::ostream& out, const packet_set_food& p) {
 
 std::ostream& operator<<(std::ostream& out, const packet_spawn_food& p) {
   out << static_cast<PacketBase>(p) << write_uint8(p.m_food.color)
-      << write_uint16(p.m_food.x) << write_uint16(p.m_food.y)
+      << write_coord(p.m_food.x) << write_coord(p.m_food.y)
       << write_uint8(p.m_food.size * 5);
   return out;
 }
 
 std::ostream& operator<<(std::ostream& out, const packet_add_food& p) {
   out << static_cast<PacketBase>(p) << write_uint8(p.m_food.color)
-      << write_uint16(p.m_food.x) << write_uint16(p.m_food.y)
+      << write_coord(p.m_food.x) << write_coord(p.m_food.y)
       << write_uint8(p.m_food.size * 5);
   return out;
 }
 
 std::ostream& operator<<(std::ostream& out, const packet_eat_food& p) {
-  out << static_cast<PacketBase>(p) << write_uint16(p.m_food.x)
-      << write_uint16(p.m_food.y);
+  out << static_cast<PacketBase>(p) << write_coord(p.m_food.x)
+      << write_coord(p.m_food.y);
   if (p.snakeId > 0) {
     out << write_uint16(p.snakeId);
   }
@@ -4,23 +4,25 @@
 #include <vector>
 
 #include "game/food.h"
+#include "game/sector.h"
 #include "packet/p_base.h"
 
 // Sent when food that existed before enters range.
 // The food id is calculated with (y * GameRadius * 3) + x
 struct packet_set_food : public PacketBase {
-  explicit packet_set_food(const std::vector<Food>* ptr)
-      : PacketBase(packet_t_set_food), food_ptr(ptr) {}
+  explicit packet_set_food(const Sector* ptr)
+      : PacketBase(packet_t_set_food), sector_ptr(ptr) {}
 
   /**
-   * 3    int8    Color?
-   * 4-5  int16   Food X
-   * 6-7  int16   Food Y
-   * 8    int8    value / 5 -> Size
+   * per food, coords are wire_coord_size bytes, 2 in the stock geometry:
+   * int8    Color?
+   * coord   Food X
+   * coord   Food Y
+   * int8    value / 5 -> Size
    */
-  const std::vector<Food>* food_ptr;
+  const Sector* sector_ptr;
 
-  size_t get_size() const noexcept { return 3 + food_ptr->size() * 6; }
+  size_t get_size() const noexcept { return 3 + sector_ptr->food.size() * (2 + 2 * wire_coord_size); }
 };
 
 // Sent when food is created while in range (because of turbo or the death of a
@@ -32,14 +34,14 @@ struct packet_spawn_food : public PacketBase {
       : PacketBase(packet_t_spawn_food), m_food(f) {}
 
   /**
-   * 3    int8    Color?
-   * 4-5  int16    Food X
-   * 6-7  int16    Food Y
-   * 8    int8    value / 5 -> Size
+   * 3       int8    Color?
+   * 4-5     coord   Food X, wire_coord_size bytes, 2 in the stock geometry
+   * 6-7     coord   Food Y
+   * 8       int8    value / 5 -> Size
    */
   Food m_food;
 
-  size_t get_size() const noexcept { return 3 + 6; }
+  size_t get_size() const noexcept { return 3 + 2 + 2 * wire_coord_size; }
 };
 
 // Sent when natural food spawns while in range.
@@ -50,14 +52,14 @@ struct packet_add_food : public PacketBase {
       : PacketBase(packet_t_add_food), m_food(f) {}
 
   /**
-   * 3    int8    Color?
-   * 4-5  int16   Food X
-   * 6-7  int16   Food Y
-   * 8    int8    value / 5 -> Size
+   * 3       int8    Color?
+   * 4-5     coord   Food X, wire_coord_size bytes, 2 in the stock geometry
+   * 6-7     coord   Food Y
+   * 8       int8    value / 5 -> Size
    */
   Food m_food;
 
-  size_t get_size() const noexcept { return 3 + 6; }
+  size_t get_size() const noexcept { return 3 + 2 + 2 * wire_coord_size; }
 };
 
 struct packet_eat_food : public PacketBase {
@@ -66,15 +68,15 @@ struct packet_eat_food : public PacketBase {
       : PacketBase(packet_t_eat_food), m_food(f), snakeId(id) {}
 
   /**
-   * 3-4    int16    Food X
-   * 5-6    int16    Food Y
+   * 3-4    coord    Food X, wire_coord_size bytes, 2 in the stock geometry
+   * 5-6    coord    Food Y
    */
   Food m_food;
 
   // 7-8    int16    Eater snake id
   uint16_t snakeId = 0;
 
-  size_t get_size() const noexcept { return 3 + 6; }
+  size_t get_size() const noexcept { return 3 + 2 * wire_coord_size + 2; }
 };
 
 std::ostream& operator<<(std::ostream& out, const packet_set_food& p);
@@ -4,6 +4,9 @@
 #include <cstdint>
 #include <ostream>
 #include <string>
+#include <type_traits>
+
+#include "game/config.h"
 
 #define M_2PI (2.0 * 3.14159265358979323846) /* 2 * pi */
 
@@ -51,6 +54,19 @@ inline ostream_write_value<uint24_t> write_ang24(fixed_point_t v) {
 }
 
 ostream_write_value<uint24_t> write_fp24(fixed_point_t v);
+
+// map positions and sector indices are as wide as the world geometry needs:
+// 16 and 8 bit in the stock protocol, 24 and 16 bit for wide worlds
+typedef std::conditional<sizeof(WorldConfig::coord_t) == 2, uint16_t, uint24_t>::type wire_coord_t;
+typedef std::conditional<sizeof(WorldConfig::sector_index_t) == 1, uint8_t, uint16_t>::type wire_sector_t;
+
+// bytes written, uint24_t is held in 32 bits but written in 3
+static const size_t wire_coord_size = sizeof(wire_coord_t) == 2 ? 2 : 3;
+static const size_t wire_sector_size = sizeof(wire_sector_t);
+
+inline ostream_write_value<wire_coord_t> write_coord(WorldConfig::coord_t v) { return {v}; }
+
+inline ostream_write_value<wire_sector_t> write_sector(WorldConfig::sector_index_t v) { return {v}; }
 ostream_write_value<const std::string&> write_string(const std::string& s);
 
 #endif  // SRC_PACKET_P_FORMAT_H_
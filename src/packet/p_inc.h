@@ -6,7 +6,7 @@
 
 struct packet_inc : public PacketBase {
   packet_inc() : PacketBase(packet_t_inc) {}
-  packet_inc(uint16_t in_snakeId, uint16_t in_x, uint16_t in_y, uint8_t in_f)
+  packet_inc(uint16_t in_snakeId, WorldConfig::coord_t in_x, WorldConfig::coord_t in_y, uint8_t in_f)
       : PacketBase(packet_t_inc),
         snakeId(in_snakeId),
         x(in_x),
@@ -15,16 +15,17 @@ struct packet_inc : public PacketBase {
   explicit packet_inc(const Snake* s)
       : PacketBase(packet_t_inc),
         snakeId(s->id),
-        x(static_cast<uint16_t>(s->get_head_x())),
-        y(static_cast<uint16_t>(s->get_head_y())),
+        x(static_cast<WorldConfig::coord_t>(s->get_head_x())),
+        y(static_cast<WorldConfig::coord_t>(s->get_head_y())),
         fullness(static_cast<uint8_t>(s->fullness)) {}
 
   uint16_t snakeId = 0;  // 3-4, int16, Snake id
-  uint16_t x = 0;        // 5-6, int16, x
-  uint16_t y = 0;        // 7-8, int16, y
+  // offsets of the stock geometry, coords are wire_coord_size bytes
+  WorldConfig::coord_t x = 0;  // 5-6, coord, x
+  WorldConfig::coord_t y = 0;  // 7-8, coord, y
   uint8_t fullness = 0;  // 9-11, int24, value / 16777215 -> fam
 
-  size_t get_size() const noexcept { return 12; }
+  size_t get_size() const noexcept { return 3 + 2 + 2 * wire_coord_size + 3; }
 };
 
 struct packet_inc_rel : public PacketBase {
@@ -3,8 +3,8 @@
 std::ostream& operator<<(std::ostream& out, const packet_move& p) {
   out << static_cast<PacketBase>(p);
   out << write_uint16(p.snakeId);
-  out << write_uint16(p.x);
-  out << write_uint16(p.y);
+  out << write_coord(p.x);
+  out << write_coord(p.y);
   return out;
 }
 
@@ -6,19 +6,20 @@
 
 struct packet_move : public PacketBase {
   packet_move() : PacketBase(packet_t_mov) {}
-  packet_move(uint16_t in_snakeId, uint16_t in_x, uint16_t in_y)
+  packet_move(uint16_t in_snakeId, WorldConfig::coord_t in_x, WorldConfig::coord_t in_y)
       : PacketBase(packet_t_mov), snakeId(in_snakeId), x(in_x), y(in_y) {}
   explicit packet_move(const Snake* s)
       : PacketBase(packet_t_mov),
         snakeId(s->id),
-        x(static_cast<uint16_t>(s->get_head_x())),
-        y(static_cast<uint16_t>(s->get_head_y())) {}
+        x(static_cast<WorldConfig::coord_t>(s->get_head_x())),
+        y(static_cast<WorldConfig::coord_t>(s->get_head_y())) {}
 
   uint16_t snakeId = 0;  // 3-4, int16, Snake id
-  uint16_t x = 0;        // 5-6, int16, x
-  uint16_t y = 0;        // 7-8, int16, y
+  // offsets of the stock geometry, coords are wire_coord_size bytes
+  WorldConfig::coord_t x = 0;  // 5-6, coord, x
+  WorldConfig::coord_t y = 0;  // 7-8, coord, y
 
-  size_t get_size() const noexcept { return 9; }
+  size_t get_size() const noexcept { return 3 + 2 + 2 * wire_coord_size; }
 };
 
 struct packet_move_rel : public PacketBase {
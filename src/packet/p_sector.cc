@@ -2,7 +2,7 @@
 
 std::ostream& operator<<(std::ostream& out, const packet_sector& p) {
   out << static_cast<PacketBase>(p);
-  out << write_uint8(p.x);
-  out << write_uint8(p.y);
+  out << write_sector(p.x);
+  out << write_sector(p.y);
   return out;
 }
@@ -5,10 +5,10 @@ std::ostream& operator<<(std::ostream& out, const packet_add_snake& p) {
 
   const Snake* s = p.s;
 
-  out << write_uint16(s->id) << write_ang24(s->angle)  // ehang radians
+  out << write_uint16(s->id) << write_ang24(s->state->angle)  // ehang radians
       << write_uint8(0)                                // unknown
-      << write_ang24(s->angle)                         // eangle radians
-      << write_fp16<3>(s->speed /
+      << write_ang24(s->state->angle)                         // eangle radians
+      << write_fp16<3>(s->state->speed /
                        32.0f)  // pixels / second -> pixels / 4 * vfr (8ms)
       << write_fp24(s->fullness / 100.0f) << write_uint8(s->skin)
       << write_uint24(s->get_head_x() * 5.0f)
@@ -30,7 +30,8 @@ struct packet_add_snake : public PacketBase {
   const Snake* s;
 
   size_t get_size() const noexcept {
-    return 25 + s->name.length() + 2 * 3 + (s->parts.size() - 1 /* head */) * 2;
+    // the tail is absolute, the parts up to the head are relative
+    return 25 + s->name.length() + (s->parts.empty() ? 0 : 2 * 3 + (s->parts.size() - 2 /* head, tail */) * 2);
   }
 };
 
@@ -0,0 +1,5 @@
+#include "replay/replay.h"
+
+int main(const int argc, const char* const argv[]) {
+  return std::unique_ptr<Replayer>(new Replayer())->Run(ParseCommandLine(argc, argv));
+}
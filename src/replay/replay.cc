@@ -0,0 +1,276 @@
+#include "replay/replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include "packet/p_base.h"
+
+namespace po = boost::program_options;
+
+ReplayConfig ParseCommandLine(const int argc, const char *const *argv) {
+  ReplayConfig config;
+
+  po::options_description options("Options");
+  options.add_options()("help,h", po::bool_switch(&config.help),
+                        "print help message")(
+      "journal,j", po::value<std::string>(&config.journal_file),
+      "journal file recorded with slither_server --journal")(
+      "loops,n", po::value<uint16_t>(&config.loops)->default_value(config.loops),
+      "replay the journal n times");
+
+  po::positional_options_description positional;
+  positional.add("journal", 1);
+
+  po::variables_map vm;
+
+  try {
+    po::store(po::command_line_parser(argc, argv).options(options).positional(positional).run(), vm);
+    po::notify(vm);
+  } catch (const po::error &e) {
+    std::cerr << "error: " << e.what() << '\n';
+    config.help = true;
+  }
+
+  if (!config.help && config.journal_file.empty()) {
+    std::cerr << "error: journal file is required\n";
+    config.help = true;
+  }
+
+  if (config.help) {
+    std::cerr << "Usage: slither_replay [OPTIONS] JOURNAL\n";
+    std::cerr << options << '\n';
+    exit(1);
+  }
+
+  return config;
+}
+
+int Replayer::Run(ReplayConfig in_config) {
+  config = in_config;
+
+  if (!Load()) {
+    return 1;
+  }
+
+  for (uint16_t i = 0; i < config.loops; i++) {
+    Replay();
+  }
+
+  return 0;
+}
+
+bool Replayer::Load() {
+  if (!reader.Open(config.journal_file)) {
+    std::cerr << "error: failed to open journal " << config.journal_file << '\n';
+    return false;
+  }
+
+  JournalRecord r;
+  while (reader.Next(&r)) {
+    records.push_back(r);
+  }
+
+  const WorldConfig &wc = reader.GetConfig();
+  std::cout << "Journal " << config.journal_file << ", " << records.size() << " records, seed " << wc.seed
+            << ", bots " << wc.bots << std::endl;
+  return true;
+}
+
+void Replayer::Replay() {
+  using std::chrono::steady_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  world.reset(new World());
+  world->Init(reader.GetConfig());
+  ids.clear();
+  tick_ns.clear();
+  sim_ms = 0;
+  mismatched_ids = 0;
+
+  const auto start = steady_clock::now();
+
+  for (const JournalRecord &r : records) {
+    switch (r.type) {
+      case journal_tick: {
+        const auto tick_start = steady_clock::now();
+        Tick(r.dt);
+        tick_ns.push_back(duration_cast<nanoseconds>(steady_clock::now() - tick_start).count());
+        break;
+      }
+
+      case journal_join:
+        Join(r.id);
+        break;
+
+      case journal_leave:
+        Leave(r.id);
+        break;
+
+      case journal_packet:
+        Apply(r.id, r.payload);
+        break;
+    }
+  }
+
+  Report(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+}
+
+void Replayer::Join(snake_id_t id) {
+  const auto s = world->CreateSnake();
+  world->AddSnake(s);
+  ids[id] = s->id;
+
+  if (s->id != id) {
+    mismatched_ids++;
+  }
+}
+
+void Replayer::Leave(snake_id_t id) {
+  const auto i = ids.find(id);
+  if (i != ids.end()) {
+    world->RemoveSnake(i->second);
+    ids.erase(i);
+  }
+}
+
+// Only inputs that affect the simulation, mirrors Room::on_message.
+void Replayer::Apply(snake_id_t id, const std::string &payload) {
+  const auto i = ids.find(id);
+  if (i == ids.end() || payload.empty()) {
+    return;
+  }
+
+  const uint8_t packet_type = static_cast<uint8_t>(payload[0]);
+
+  if (packet_type <= 250 && payload.size() == 1) {
+    world->InputAngle(i->second, packet_type);
+    return;
+  }
+
+  switch (packet_type) {
+    case in_packet_t_start_acc:
+    case in_packet_t_stop_acc:
+      world->InputBoost(i->second, packet_type == in_packet_t_start_acc);
+      break;
+
+    default:
+      break;
+  }
+}
+
+void Replayer::Tick(long dt) {
+  sim_ms += dt;
+  world->Tick(dt);
+  FlushUpdates();
+}
+
+// Mirrors the world side effects of GameServer::BroadcastUpdates and
+// RemoveDeadSnakes: update flags, food and viewport deltas, dead snakes.
+void Replayer::FlushUpdates() {
+  for (Snake *s : world->GetChangedSnakes()) {
+    const uint8_t flags = s->state->update;
+
+    if (flags & change_dead) {
+      continue;
+    }
+
+    if (flags & change_dying) {
+      s->on_dead_food_spawn(&world->GetSectors(), &world->GetRandom());
+      s->eaten.clear();
+      s->spawn.clear();
+      s->state->update |= change_dead;
+
+      if (s->bot) {
+        world->GetDead().push_back(s->id);
+      }
+      continue;
+    }
+
+    if (flags & change_angle) {
+      s->state->update ^= change_angle;
+      if (flags & change_wangle) {
+        s->state->update ^= change_wangle;
+      }
+    }
+
+    if (flags & change_speed) {
+      s->state->update ^= change_speed;
+    }
+
+    if (flags & change_pos) {
+      s->state->update ^= change_pos;
+
+      if (s->clientPartsIndex < s->parts.size()) {
+        s->clientPartsIndex++;
+      } else if (s->clientPartsIndex > s->parts.size()) {
+        s->clientPartsIndex--;
+      }
+
+      s->eaten.clear();
+      s->spawn.clear();
+      if (!s->bot) {
+        s->vp.CollectChanges(&world->GetSectors());
+        s->vp.new_sectors.clear();
+        s->vp.old_sectors.clear();
+
+        if (flags & change_fullness) {
+          s->state->update ^= change_fullness;
+        }
+      }
+    }
+  }
+
+  world->FlushChanges();
+
+  for (auto id : world->GetDead()) {
+    world->RemoveSnake(id);
+  }
+  world->GetDead().clear();
+}
+
+// order independent digest of snake positions, equal for equal replays
+uint64_t Replayer::GetWorldHash() {
+  uint64_t hash = 0;
+
+  for (const auto &pair : world->GetSnakes()) {
+    const Snake *s = pair.second.get();
+    uint64_t h = 1469598103934665603ull;
+    const uint32_t values[] = {s->id, static_cast<uint32_t>(s->parts.size()),
+                               static_cast<uint32_t>(s->get_head_x() * 100.0f),
+                               static_cast<uint32_t>(s->get_head_y() * 100.0f)};
+    for (uint32_t v : values) {
+      h = (h ^ v) * 1099511628211ull;
+    }
+    hash += h;
+  }
+
+  return hash;
+}
+
+void Replayer::Report(uint64_t wall_ns) {
+  std::vector<uint64_t> sorted = tick_ns;
+  std::sort(sorted.begin(), sorted.end());
+
+  const auto percentile = [&sorted](double q) -> uint64_t {
+    return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(q * sorted.size()))];
+  };
+
+  const double wall_ms = wall_ns / 1e6;
+  std::cout << "Replayed " << tick_ns.size() << " ticks, " << sim_ms << "ms of game in " << wall_ms << "ms"
+            << " (x" << (wall_ms > 0.0 ? sim_ms / wall_ms : 0.0) << ")"
+            << ", tick us p50 " << percentile(0.5) / 1000
+            << " p99 " << percentile(0.99) / 1000
+            << " p999 " << percentile(0.999) / 1000
+            << " max " << (sorted.empty() ? 0 : sorted.back() / 1000)
+            << ", snakes " << world->GetSnakes().size()
+            << ", world hash " << std::hex << GetWorldHash() << std::dec << std::endl;
+
+  if (mismatched_ids > 0) {
+    std::cout << "Warning: " << mismatched_ids << " snake ids differ from the recording, replay diverged"
+              << std::endl;
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef SRC_REPLAY_REPLAY_H_
+#define SRC_REPLAY_REPLAY_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "game/journal.h"
+#include "game/world.h"
+
+struct ReplayConfig {
+  std::string journal_file;
+  uint16_t loops = 1;  // replays of the journal, each on a fresh world
+
+  bool help = false;
+};
+
+ReplayConfig ParseCommandLine(const int argc, const char *const *argv);
+
+// Drives a headless world from a recorded journal as fast as possible. The
+// world is seeded and configured from the journal header, so a replay
+// repeats the recorded session step by step.
+class Replayer {
+ public:
+  int Run(ReplayConfig in_config);
+
+ private:
+  bool Load();
+  void Replay();
+
+  void Join(snake_id_t id);
+  void Leave(snake_id_t id);
+  void Apply(snake_id_t id, const std::string &payload);
+  void Tick(long dt);
+  void FlushUpdates();
+
+  uint64_t GetWorldHash();
+  void Report(uint64_t wall_ns);
+
+ private:
+  ReplayConfig config;
+  JournalReader reader;
+  std::vector<JournalRecord> records;
+
+  std::unique_ptr<World> world;
+  // journal snake id -> replay snake id
+  std::unordered_map<snake_id_t, snake_id_t> ids;
+
+  std::vector<uint64_t> tick_ns;
+  uint64_t sim_ms = 0;
+  uint64_t mismatched_ids = 0;
+};
+
+#endif  // SRC_REPLAY_REPLAY_H_
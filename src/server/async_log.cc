@@ -0,0 +1,152 @@
+#include "server/async_log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+static const std::memory_order relaxed = std::memory_order_relaxed;
+
+constexpr long AsyncLog::idle_ms;
+
+bool LogSite::Admit(int64_t second, uint32_t *suppressed) {
+  int64_t w = window.load(relaxed);
+  if (w != second && window.compare_exchange_strong(w, second, relaxed)) {
+    admitted.store(0, relaxed);
+  }
+
+  if (admitted.fetch_add(1, relaxed) >= per_second) {
+    skipped.fetch_add(1, relaxed);
+    return false;
+  }
+
+  *suppressed = skipped.exchange(0, relaxed);
+  return true;
+}
+
+AsyncLog::AsyncLog(WSPPServer *server) : endpoint(*server), cells(capacity) {
+  for (size_t i = 0; i < capacity; i++) {
+    cells[i].seq.store(i, relaxed);
+  }
+}
+
+AsyncLog::~AsyncLog() { Stop(); }
+
+void AsyncLog::Start() {
+  running.store(true, std::memory_order_release);
+  thread = std::thread([this]() { Run(); });
+}
+
+void AsyncLog::Stop() {
+  running.store(false, std::memory_order_release);
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+bool AsyncLog::Write(uint16_t room, LogSite *site, long long a, long long b, long long c) {
+  using std::chrono::duration_cast;
+  using std::chrono::seconds;
+  using std::chrono::steady_clock;
+
+  Record r;
+  const int64_t second = duration_cast<seconds>(steady_clock::now().time_since_epoch()).count();
+  if (!site->Admit(second, &r.suppressed)) {
+    return false;
+  }
+
+  r.site = site;
+  r.room = room;
+  r.args[0] = a;
+  r.args[1] = b;
+  r.args[2] = c;
+  return Push(&r);
+}
+
+bool AsyncLog::Write(uint16_t room, std::string text) {
+  Record r;
+  r.room = room;
+  r.text = std::move(text);
+  return Push(&r);
+}
+
+bool AsyncLog::Push(Record *r) {
+  size_t pos = tail.load(relaxed);
+  for (;;) {
+    Cell &cell = cells[pos & (capacity - 1)];
+    const size_t seq = cell.seq.load(std::memory_order_acquire);
+
+    if (seq == pos) {
+      if (tail.compare_exchange_weak(pos, pos + 1, relaxed)) {
+        cell.record = std::move(*r);
+        cell.seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (seq < pos) {
+      // the reader is a lap behind
+      overflows.fetch_add(1, relaxed);
+      return false;
+    } else {
+      pos = tail.load(relaxed);
+    }
+  }
+}
+
+bool AsyncLog::Pop(Record *r) {
+  Cell &cell = cells[head & (capacity - 1)];
+  if (cell.seq.load(std::memory_order_acquire) != head + 1) {
+    return false;
+  }
+
+  *r = std::move(cell.record);
+  cell.seq.store(head + capacity, std::memory_order_release);
+  head++;
+  return true;
+}
+
+bool AsyncLog::Drain() {
+  bool printed = false;
+  Record r;
+  while (Pop(&r)) {
+    Print(r);
+    printed = true;
+  }
+
+  const uint64_t n = overflows.load(relaxed);
+  if (n != reported) {
+    endpoint.get_alog().write(alevel::app, "Log ring is full, dropped " + std::to_string(n - reported) + " messages");
+    reported = n;
+    printed = true;
+  }
+
+  return printed;
+}
+
+void AsyncLog::Print(const Record &r) {
+  std::string message;
+  if (r.room != no_room) {
+    message = "Room " + std::to_string(r.room) + ": ";
+  }
+
+  if (r.site != nullptr) {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), r.site->get_format(), r.args[0], r.args[1], r.args[2]);
+    message += buf;
+  } else {
+    message += r.text;
+  }
+
+  if (r.suppressed > 0) {
+    message += " (" + std::to_string(r.suppressed) + " similar suppressed)";
+  }
+
+  endpoint.get_alog().write(alevel::app, message);
+}
+
+void AsyncLog::Run() {
+  while (running.load(std::memory_order_acquire)) {
+    if (!Drain()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(idle_ms));
+    }
+  }
+  Drain();
+}
@@ -0,0 +1,98 @@
+#ifndef SRC_SERVER_ASYNC_LOG_H_
+#define SRC_SERVER_ASYNC_LOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server/server.h"
+
+// Log message call site: a printf format of up to AsyncLog::max_args long
+// long values and a rate limit. Sites are static and shared by all rooms, the
+// limit is per site, not per room.
+class LogSite {
+ public:
+  constexpr explicit LogSite(const char *in_format, uint32_t in_per_second = 10)
+      : format(in_format), per_second(in_per_second) {}
+
+  // true if the message fits the limit of the given second, then suppressed
+  // is the count of its messages skipped since the last admitted one
+  bool Admit(int64_t second, uint32_t *suppressed);
+
+  inline const char *get_format() const { return format; }
+
+ private:
+  const char *const format;
+  const uint32_t per_second;
+
+  std::atomic<int64_t> window{-1};
+  std::atomic<uint32_t> admitted{0};
+  std::atomic<uint32_t> skipped{0};
+};
+
+// Application log off the game threads. Writers put fixed size records to a
+// bounded lock-free ring, formatting of site messages is deferred to the
+// writer thread, which prints to the endpoint access log. A message is
+// dropped when its site is over the rate limit or the ring is full, Write
+// never blocks.
+class AsyncLog {
+ public:
+  explicit AsyncLog(WSPPServer *server);
+  ~AsyncLog();
+
+  AsyncLog(const AsyncLog &) = delete;
+  AsyncLog &operator=(const AsyncLog &) = delete;
+
+  void Start();
+  // prints what is queued and joins the writer thread
+  void Stop();
+
+  // false if dropped
+  bool Write(uint16_t room, LogSite *site, long long a = 0, long long b = 0, long long c = 0);
+  // preformatted, not rate limited, for rare messages
+  bool Write(uint16_t room, std::string text);
+
+  static const uint16_t no_room = 0xffff;
+  static const size_t max_args = 3;
+  static const size_t capacity = 1 << 12;
+
+ private:
+  struct Record {
+    const LogSite *site = nullptr;  // nullptr for a preformatted text
+    std::string text;
+    long long args[max_args] = {};
+    uint32_t suppressed = 0;
+    uint16_t room = no_room;
+  };
+
+  // ring slot, seq tells whose turn it is: the writer of the position equal
+  // to it, or the reader of the position one behind
+  struct Cell {
+    std::atomic<size_t> seq{0};
+    Record record;
+  };
+
+  bool Push(Record *r);
+  bool Pop(Record *r);
+  // true if anything was printed
+  bool Drain();
+  void Print(const Record &r);
+  void Run();
+
+  WSPPServer &endpoint;
+
+  std::vector<Cell> cells;
+  std::atomic<size_t> tail{0};  // next position to write
+  size_t head = 0;              // next position to read, writer thread only
+
+  std::atomic<uint64_t> overflows{0};
+  uint64_t reported = 0;  // overflows at the last report, writer thread only
+
+  std::atomic<bool> running{false};
+  std::thread thread;
+  static constexpr long idle_ms = 5;
+};
+
+#endif  // SRC_SERVER_ASYNC_LOG_H_
@@ -2,6 +2,8 @@
 
 #include <boost/program_options.hpp>
 
+#include "server/tls.h"
+
 namespace po = boost::program_options;
 
 // bug clang++ 3.5 vs new gcc abi cant link against libboost build with gcc
@@ -25,7 +27,19 @@ IncomingConfig ParseCommandLine(const int argc, const char *const *argv) {
       "cert", po::value<std::string>(&config.tls_cert_file),
       "path to TLS certificate file (required when --tls is enabled)")(
       "key", po::value<std::string>(&config.tls_key_file),
-      "path to TLS private key file (required when --tls is enabled)");
+      "path to TLS private key file (required when --tls is enabled)")(
+      "ticket_key", po::value<std::string>(&config.tls_ticket_key_file),
+      "path to a file of 80 random bytes encrypting TLS session tickets, random per start if not set")(
+      "tls_threads", po::value<uint16_t>(&config.tls_threads)->default_value(config.tls_threads),
+      "threads serving connections and TLS handshakes with --tls, 0 - half the cores")(
+      "rooms", po::value<uint16_t>(&config.rooms)->default_value(config.rooms),
+      "independent game rooms, each on its own thread, 0 - one per core")(
+      "room_capacity", po::value<uint16_t>(&config.room_capacity)->default_value(config.room_capacity),
+      "max players in a room")(
+      "max_spectators", po::value<uint16_t>(&config.max_spectators)->default_value(config.max_spectators),
+      "max spectators of a room, more are turned away with try again later")(
+      "workers", po::value<uint16_t>(&config.workers)->default_value(config.workers),
+      "worker processes sharing the port with SO_REUSEPORT under a supervisor, 0 - single process");
 
   po::options_description conf("Configuration");
   conf.add_options()(
@@ -37,7 +51,21 @@ IncomingConfig ParseCommandLine(const int argc, const char *const *argv) {
       "init snake average length")(
       "min_len", po::value<uint16_t>(&config.world.snake_min_length)
                      ->default_value(config.world.snake_min_length),
-      "init snake min length");
+      "init snake min length")(
+      "bot_budget", po::value<uint16_t>(&config.world.bot_decisions_per_tick)
+                        ->default_value(config.world.bot_decisions_per_tick),
+      "max bot decisions per tick")(
+      "bot_lod", po::value<uint16_t>(&config.world.bot_lod_interval)
+                     ->default_value(config.world.bot_lod_interval),
+      "step interval of bots no one observes, ms, 0 - disable")(
+      "seed", po::value<uint32_t>(&config.world.seed)->default_value(config.world.seed),
+      "world random seed, 0 - from time")(
+      "journal", po::value<std::string>(&config.journal_file),
+      "record world inputs to the journal file for slither_replay")(
+      "snapshot", po::value<std::string>(&config.snapshot_file),
+      "restore the world from the snapshot file on start, save it there periodically and on shutdown")(
+      "snapshot_interval", po::value<uint16_t>(&config.snapshot_interval)->default_value(config.snapshot_interval),
+      "seconds between snapshots, 0 - only on shutdown");
 
   po::options_description cmdline_options;
   cmdline_options.add(generic).add(conf);
@@ -64,6 +92,13 @@ IncomingConfig ParseCommandLine(const int argc, const char *const *argv) {
       std::cerr << "error: --cert and --key are required when --tls is enabled\n";
       exit(1);
     }
+
+    try {
+      config.tls_ticket_keys = LoadTicketKeys(config.tls_ticket_key_file);
+    } catch (std::exception &e) {
+      std::cerr << "error: " << e.what() << '\n';
+      exit(1);
+    }
   }
 
   return config;
@@ -20,6 +20,22 @@ struct IncomingConfig {
 
   std::string tls_cert_file;
   std::string tls_key_file;
+  std::string tls_ticket_key_file;
+  std::string tls_ticket_keys;  // loaded before the workers fork, kept across reloads
+  uint16_t tls_threads = 0;  // listener threads in wss mode, 0 - half the cores
+
+  std::string journal_file;
+
+  std::string snapshot_file;
+  uint16_t snapshot_interval = 60;  // s, 0 - only on shutdown
+
+  uint16_t rooms = 1;            // 0 - one per core
+  uint16_t room_capacity = 100;  // players
+  uint16_t max_spectators = 16;  // per room
+
+  uint16_t workers = 0;     // 0 - no supervisor, serve from this process
+  bool reuse_port = false;  // set for workers
+  int control_fd = -1;      // worker end of the supervisor channel
 
   WorldConfig world;
 };
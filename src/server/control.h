@@ -0,0 +1,20 @@
+#ifndef SRC_SERVER_CONTROL_H_
+#define SRC_SERVER_CONTROL_H_
+
+#include <cstdint>
+
+// Messages between the supervisor and its workers over a local unix datagram
+// socket pair, one per worker. A worker reports its load periodically, the
+// supervisor answers with the totals over all live workers.
+struct ControlReport {
+  uint32_t players = 0;
+  uint32_t capacity = 0;
+};
+
+struct ControlState {
+  uint32_t players = 0;
+  uint32_t capacity = 0;
+  uint32_t workers = 0;
+};
+
+#endif  // SRC_SERVER_CONTROL_H_
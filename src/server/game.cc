@@ -1,10 +1,16 @@
 #include "server/game.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include <thread>
 
-#include "game/math.h"
+static LogSite log_no_place("No place for a player, connection rejected");
+static LogSite log_no_room("No room, skip packet");
+static LogSite log_no_spectator_place("No place for a spectator, connection rejected");
 
-GameServer::GameServer() {
+GameServer::GameServer() : log(&endpoint) {
   // set up access channels to only log interesting things
   endpoint.clear_access_channels(alevel::all);
   endpoint.set_access_channels(alevel::access_core);
@@ -16,287 +22,216 @@ GameServer::GameServer() {
 
   // Bind the handlers we are using
   endpoint.set_socket_init_handler(bind(&GameServer::on_socket_init, this, ::_1, ::_2));
+  endpoint.set_tcp_pre_bind_handler(bind(&GameServer::on_pre_bind, this, ::_1));
   endpoint.set_tls_init_handler(bind(&GameServer::on_tls_init, this, ::_1));
 
-  endpoint.set_open_handler(bind(&GameServer::on_open, this, _1));
-  endpoint.set_message_handler(bind(&GameServer::on_message, this, _1, _2));
-  endpoint.set_close_handler(bind(&GameServer::on_close, this, _1));
+  // connection events come from any endpoint thread, on_http reads only
+  // atomics and the fixed rooms list
+  listener.reset(new boost::asio::io_service::strand(endpoint.get_io_service()));
+  endpoint.set_open_handler([this](connection_hdl hdl) { listener->dispatch([this, hdl]() { on_open(hdl); }); });
+  endpoint.set_message_handler([this](connection_hdl hdl, message_ptr ptr) {
+    listener->dispatch([this, hdl, ptr]() { on_message(hdl, ptr); });
+  });
+  endpoint.set_close_handler([this](connection_hdl hdl) { listener->dispatch([this, hdl]() { on_close(hdl); }); });
+  endpoint.set_http_handler(bind(&GameServer::on_http, this, _1));
 }
 
 int GameServer::Run(IncomingConfig in_config) {
   config = in_config;
 
+  if (config.rooms == 0) {
+    config.rooms = static_cast<uint16_t>(std::max(1u, std::thread::hardware_concurrency()));
+  }
+
+  // rooms differ, but each one is reproducible from the logged seed
+  if (config.world.seed == 0) {
+    config.world.seed = static_cast<uint32_t>(std::time(nullptr));
+  }
+
   std::string protocol = config.use_tls ? "wss://" : "ws://";
   endpoint.get_alog().write(alevel::app,
-      "Running slither server on port " + std::to_string(in_config.port) +
-      " (" + protocol + ")");
+      "Running slither server on port " + std::to_string(config.port) +
+      " (" + protocol + "), " + std::to_string(config.rooms) + " rooms of " +
+      std::to_string(config.room_capacity) + " players");
 
-  PrintWorldInfo();
+  if (config.use_tls && !LoadTls()) {
+    return 1;
+  }
 
-  endpoint.listen(in_config.port);
+  log.Start();
+  endpoint.listen(config.port);
   endpoint.start_accept();
 
-  world.Init(in_config.world);
-  init = BuildInitPacket();
-  NextTick(GetCurrentTime());
+  for (uint16_t i = 0; i < config.rooms; i++) {
+    IncomingConfig room_config = config;
+    room_config.world.seed = config.world.seed + i;
+    if (config.rooms > 1 && !config.journal_file.empty()) {
+      room_config.journal_file += "." + std::to_string(i);
+    }
+    if (config.rooms > 1 && !config.snapshot_file.empty()) {
+      room_config.snapshot_file += "." + std::to_string(i);
+    }
+
+    rooms.emplace_back(new Room(&endpoint, &log, i));
+    rooms.back()->Start(room_config);
+  }
+  players.assign(rooms.size(), 0);
+  spectators.assign(rooms.size(), 0);
+
+  StartControl();
+
+  signals.reset(new boost::asio::signal_set(endpoint.get_io_service(), SIGINT, SIGTERM, SIGHUP));
+  signals->async_wait(listener->wrap(bind(&GameServer::on_signal, this, ::_1, ::_2)));
 
+  StartPool();
+
+  int code = 0;
   try {
     endpoint.get_alog().write(alevel::app, "Server started...");
     endpoint.run();
-    return 0;
   } catch (websocketpp::exception const &e) {
     std::cout << e.what() << std::endl;
-    return 1;
+    endpoint.stop();
+    code = 1;
   }
-}
-
-void GameServer::PrintWorldInfo() {
-  std::stringstream s;
-  s << "World info = \n" << world;
-  endpoint.get_alog().write(alevel::app, s.str());
-}
 
-void GameServer::NextTick(long last) {
-  last_time_point = last;
-  timer = endpoint.set_timer(
-      std::max(0L, timer_interval_ms - (GetCurrentTime() - last)),
-      bind(&GameServer::on_timer, this, _1));
+  JoinPool();
+  StopRooms();
+  return code;
 }
 
-void GameServer::on_timer(error_code const &ec) {
-  const long now = GetCurrentTime();
-  const long dt = now - last_time_point;
-
-  if (ec) {
-    endpoint.get_alog().write(alevel::app,
-        "Main game loop timer error: " + ec.message());
+void GameServer::StartPool() {
+  if (!config.use_tls) {
     return;
   }
 
-  world.Tick(dt);
-  BroadcastDebug();
-  BroadcastUpdates();
-  RemoveDeadSnakes();
+  size_t threads = config.tls_threads;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+  }
 
-  const long step_time = GetCurrentTime() - now;
-  if (step_time > 10) {
-    endpoint.get_alog().write(alevel::app,
-        "Load is too high, step took " + std::to_string(step_time) + "ms");
+  for (size_t i = 1; i < threads; i++) {
+    pool.emplace_back([this]() {
+      try {
+        endpoint.run();
+      } catch (websocketpp::exception const &e) {
+        std::cout << e.what() << std::endl;
+        endpoint.stop();
+      }
+    });
   }
 
-  NextTick(now);
+  endpoint.get_alog().write(alevel::app, "Serving connections on " + std::to_string(threads) + " threads");
 }
 
-void GameServer::BroadcastDebug() {
-  if (!config.debug) {
-    return;
+void GameServer::JoinPool() {
+  for (auto &t : pool) {
+    t.join();
   }
+  pool.clear();
+}
 
-  packet_debug_draw draw;
-
-  for (Snake *s : world.GetChangedSnakes()) {
-    uint16_t sis = static_cast<uint16_t>(s->id * 1000);
-
-    // bound box
-    draw.circles.push_back(
-        d_draw_circle{sis++, {s->sbb.x, s->sbb.y}, s->sbb.r, 0xc8c8c8});
-
-    // body inner circles
-    const float r1 = s->get_snake_body_part_radius();
-
-    draw.circles.push_back(
-        d_draw_circle{sis++, {s->get_head_x(), s->get_head_y()}, r1, 0xc80000});
-
-    const Body &sec = *(s->parts.begin() + 1);
-    draw.circles.push_back(d_draw_circle{sis++, {sec.x, sec.y}, r1, 0x3c3c3c});
-    draw.circles.push_back(
-        d_draw_circle{sis++,
-                      {sec.x + (s->get_head_x() - sec.x) / 2.0f,
-                       sec.y + (s->get_head_y() - sec.y) / 2.0f},
-                      r1,
-                      0x646464});
-    draw.circles.push_back(d_draw_circle{
-        sis++, {s->parts.back().x, s->parts.back().y}, r1, 0x646464});
-
-    // bounds
-    for (const Sector *ss : s->sbb.sectors) {
-      draw.circles.push_back(
-          d_draw_circle{sis++, {ss->box.x, ss->box.y}, ss->box.r, 0x511883});
-    }
-
-    // intersection algorithm
-    static const size_t head_size = 8;
-    static const size_t tail_step = static_cast<size_t>(
-        WorldConfig::sector_size / Snake::tail_step_distance);
-    static const size_t tail_step_half = tail_step / 2;
-    const size_t len = s->parts.size();
-
-    if (len <= head_size + tail_step) {
-      for (const Body &b : s->parts) {
-        draw.circles.push_back(d_draw_circle{
-            sis++, {b.x, b.y}, WorldConfig::move_step_distance, 0x646464});
-      }
-    } else {
-      auto p = s->parts[3];
-      draw.circles.push_back(d_draw_circle{
-          sis++, {p.x, p.y}, WorldConfig::sector_size / 2, 0x848484});
-      p = s->parts[0];
-      draw.circles.push_back(d_draw_circle{
-          sis++, {p.x, p.y}, WorldConfig::move_step_distance, 0x646464});
-      p = s->parts[8];
-      draw.circles.push_back(d_draw_circle{
-          sis++, {p.x, p.y}, WorldConfig::move_step_distance, 0x646464});
-
-      auto end = s->parts.end();
-      for (auto i = s->parts.begin() + 7 + tail_step_half; i < end; i += tail_step) {
-        draw.circles.push_back(d_draw_circle{
-            sis++, {i->x, i->y}, WorldConfig::sector_size / 2, 0x848484});
-      }
-    }
+void GameServer::StopRooms() {
+  for (auto &room : rooms) {
+    room->Stop();
   }
+  log.Stop();
+}
 
-  if (!draw.empty()) {
-    broadcast_debug(draw);
+size_t GameServer::GetPlayers() const {
+  size_t count = 0;
+  for (size_t p : players) {
+    count += p;
   }
+  return count;
 }
 
-void GameServer::BroadcastUpdates() {
-  for (auto ptr : world.GetChangedSnakes()) {
-    const snake_id_t id = ptr->id;
-    const uint8_t flags = ptr->update;
-
-    if (flags & change_dead) {
-      continue;
-    }
-
-    if (flags & change_dying) {
-      endpoint.get_alog().write(alevel::app,
-        "Found dying snake " + std::to_string(id));
-
-      if (!ptr->bot) {
-        const auto ses_i = LoadSessionIter(id);
-        if (ses_i != sessions.end()) {
-          send_binary(ses_i, packet_end(packet_end::status_death));
-        }
-      }
-
-      ptr->on_dead_food_spawn(&world.GetSectors(), [&]() -> float {
-        return world.NextRandomf();
-      });
-      SendFoodUpdate(ptr);
-
-      broadcast_binary(packet_remove_snake(ptr->id, packet_remove_snake::status_snake_died));
-      broadcast_binary(packet_remove_snake(ptr->id, packet_remove_snake::status_snake_left));
-
-      ptr->update |= change_dead;
+void GameServer::StartControl() {
+  if (config.control_fd < 0) {
+    return;
+  }
 
-      if (ptr->bot) {
-        world.GetDead().push_back(ptr->id);
-      }
+  control.reset(new ControlSocket(endpoint.get_io_service()));
+  control->assign(boost::asio::local::datagram_protocol(), config.control_fd);
+  control->non_blocking(true);
 
-      continue;
-    }
+  control->async_receive(boost::asio::buffer(&control_buf, sizeof(control_buf)),
+                         listener->wrap(bind(&GameServer::on_control_read, this, ::_1, ::_2)));
+  on_control_timer(error_code());
+}
 
-    if (flags) {
-      if (flags & (change_angle | change_speed)) {
-        packet_rotation rot = packet_rotation();
-        rot.snakeId = id;
+void GameServer::on_control_timer(error_code const &ec) {
+  if (ec) {
+    return;
+  }
 
-        if (flags & change_angle) {
-          ptr->update ^= change_angle;
-          rot.ang = ptr->angle;
+  ControlReport report;
+  report.players = static_cast<uint32_t>(GetPlayers());
+  report.capacity = static_cast<uint32_t>(rooms.size() * config.room_capacity);
 
-          if (flags & change_wangle) {
-            ptr->update ^= change_wangle;
-            rot.wang = ptr->wangle;
-          }
-        }
+  // the supervisor is local and reads all the time, a lost report is resent
+  boost::system::error_code send_ec;
+  control->send(boost::asio::buffer(&report, sizeof(report)), 0, send_ec);
 
-        if (flags & change_speed) {
-          ptr->update ^= change_speed;
-          rot.snakeSpeed = ptr->speed / 32.0f;
-        }
+  control_timer =
+      endpoint.set_timer(control_interval_ms, listener->wrap(bind(&GameServer::on_control_timer, this, ::_1)));
+}
 
-        broadcast_binary(rot);
-      }
+void GameServer::on_control_read(const boost::system::error_code &ec, size_t size) {
+  if (ec) {
+    endpoint.get_alog().write(alevel::app, "Supervisor channel error: " + ec.message());
+    return;
+  }
 
-      if (flags & change_pos) {
-        ptr->update ^= change_pos;
-
-        // increase length
-        if (ptr->clientPartsIndex < ptr->parts.size()) {
-          broadcast_binary(packet_inc(ptr));
-          ptr->clientPartsIndex++;
-        } else {
-          // decrease length
-          if (ptr->clientPartsIndex > ptr->parts.size()) {
-            broadcast_binary(packet_remove_part(ptr));
-            ptr->clientPartsIndex--;
-          }
-
-          // move
-          broadcast_binary(packet_move(ptr));
-        }
-
-        SendFoodUpdate(ptr);
-        if (!ptr->bot) {
-          const auto ses_i = LoadSessionIter(id);
-          SendPOVUpdateTo(ses_i, ptr);
-
-          if (flags & change_fullness) {
-            send_binary(ses_i, packet_fullness(ptr));
-            ptr->update ^= change_fullness;
-          }
-        }
-      }
-    }
+  if (size == sizeof(control_buf)) {
+    cluster = control_buf;
   }
 
-  world.FlushChanges();
+  control->async_receive(boost::asio::buffer(&control_buf, sizeof(control_buf)),
+                         listener->wrap(bind(&GameServer::on_control_read, this, ::_1, ::_2)));
 }
 
-void GameServer::SendPOVUpdateTo(SessionIter ses_i, Snake *ptr) {
-  if (!ptr->vp.new_sectors.empty()) {
-    for (const Sector *s_ptr : ptr->vp.new_sectors) {
-      send_binary(ses_i, packet_add_sector(s_ptr->x, s_ptr->y));
-      send_binary(ses_i, packet_set_food(&s_ptr->food));
-    }
-    ptr->vp.new_sectors.clear();
+void GameServer::on_signal(const boost::system::error_code &ec, int signal) {
+  if (ec) {
+    return;
   }
 
-  if (!ptr->vp.old_sectors.empty()) {
-    for (const Sector *s_ptr : ptr->vp.old_sectors) {
-      send_binary(ses_i, packet_remove_sector(s_ptr->x, s_ptr->y));
+  if (signal == SIGHUP) {
+    if (config.use_tls && LoadTls()) {
+      endpoint.get_alog().write(alevel::app, "Reloaded TLS certificate " + config.tls_cert_file);
     }
-    ptr->vp.old_sectors.clear();
+    signals->async_wait(listener->wrap(bind(&GameServer::on_signal, this, ::_1, ::_2)));
+    return;
   }
+
+  endpoint.get_alog().write(alevel::app, "Stopping on signal " + std::to_string(signal));
+  endpoint.stop_listening();
+  endpoint.stop();
 }
 
-void GameServer::SendFoodUpdate(Snake *ptr) {
-  if (!ptr->eaten.empty()) {
-    const snake_id_t id = ptr->id;
-    for (const Food &f : ptr->eaten) {
-      // TODO(john.koepi): to those who observers me
-      broadcast_binary(packet_eat_food(id, f));
-    }
-    ptr->eaten.clear();
+bool GameServer::IsOverShare() const {
+  // all full, or alone - the own capacity decides
+  if (cluster.workers < 2 || cluster.players >= cluster.capacity) {
+    return false;
   }
 
-  if (!ptr->spawn.empty()) {
-    for (const Food &f : ptr->spawn) {
-      // TODO(john.koepi): to those who observers me
-      broadcast_binary(packet_spawn_food(f));
-    }
-    ptr->spawn.clear();
-  }
+  const size_t fair = (cluster.players + cluster.workers) / cluster.workers;
+  return GetPlayers() >= fair + share_slack;
 }
 
-void GameServer::RemoveDeadSnakes() {
-  for (auto id : world.GetDead()) {
-    RemoveSnake(id);
+Room *GameServer::AssignRoom() {
+  Room *best = nullptr;
+  size_t best_players = config.room_capacity;
+
+  for (auto &room : rooms) {
+    const size_t count = players[room->GetId()];
+    if (count < best_players) {
+      best = room.get();
+      best_players = count;
+    }
   }
 
-  world.GetDead().clear();
+  return best;
 }
 
 void GameServer::on_socket_init(websocketpp::connection_hdl, boost::asio::ip::tcp::socket &s) {
@@ -304,216 +239,145 @@ void GameServer::on_socket_init(websocketpp::connection_hdl, boost::asio::ip::tc
   s.set_option(option);
 }
 
-websocketpp::lib::shared_ptr<boost::asio::ssl::context> GameServer::on_tls_init(connection_hdl hdl) {
-  namespace asio = boost::asio;
+error_code GameServer::on_pre_bind(WSPPServer::acceptor_ptr acceptor) {
+  if (config.reuse_port) {
+    typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port;
+
+    boost::system::error_code ec;
+    acceptor->set_option(reuse_port(true), ec);
+    if (ec) {
+      endpoint.get_elog().write(elevel::fatal, "Failed to set SO_REUSEPORT: " + ec.message());
+    }
+  }
 
-  auto ctx = websocketpp::lib::make_shared<asio::ssl::context>(asio::ssl::context::tlsv12);
+  return error_code();
+}
 
+bool GameServer::LoadTls() {
   try {
-    ctx->set_options(asio::ssl::context::default_workarounds |
-                     asio::ssl::context::no_sslv2 |
-                     asio::ssl::context::no_sslv3 |
-                     asio::ssl::context::single_dh_use);
-
-    ctx->use_certificate_chain_file(config.tls_cert_file);
-    ctx->use_private_key_file(config.tls_key_file, asio::ssl::context::pem);
+    std::atomic_store(&tls, CreateTlsContext(config.tls_cert_file, config.tls_key_file, config.tls_ticket_keys));
+    return true;
   } catch (std::exception &e) {
     endpoint.get_elog().write(elevel::fatal,
         "TLS initialization error: " + std::string(e.what()));
+    return false;
   }
+}
 
-  return ctx;
+websocketpp::lib::shared_ptr<boost::asio::ssl::context> GameServer::on_tls_init(connection_hdl hdl) {
+  return std::atomic_load(&tls);
 }
 
-void GameServer::on_open(connection_hdl hdl) {
-  const auto new_snake_ptr = world.CreateSnake();
-  world.AddSnake(new_snake_ptr);
-
-  sessions[hdl] = Session(new_snake_ptr->id, GetCurrentTime());
-  connections[new_snake_ptr->id] = hdl;
-
-  endpoint.send_binary(hdl, init);
-
-  // send snake
-  const auto ses_i = sessions.find(hdl);
-  broadcast_binary(packet_add_snake(new_snake_ptr.get()));
-  broadcast_binary(packet_move(new_snake_ptr.get()));
-  SendPOVUpdateTo(ses_i, new_snake_ptr.get());
-
-  // introduce other snakes in sectors view
-  for (auto ptr : world.GetSnakes()) {
-    if (ptr.first != new_snake_ptr->id) {
-      const Snake *s = ptr.second.get();
-      send_binary(ses_i, packet_add_snake(s));
-      send_binary(ses_i, packet_move(s));
-    }
+// "/spectate[/<room>[/<snake id>]]", room 0 and a free view by default
+static bool ParseSpectate(const std::string &resource, size_t *room, snake_id_t *follow) {
+  static const std::string prefix = "/spectate";
+  if (resource.compare(0, prefix.size(), prefix) != 0) {
+    return false;
   }
-}
 
-void GameServer::on_message(connection_hdl hdl, message_ptr ptr) {
-  if (ptr->get_opcode() != opcode::binary) {
-    endpoint.get_alog().write(alevel::app,
-        "Unknown incoming message opcode " + std::to_string(ptr->get_opcode()));
-    return;
+  unsigned long values[2] = {0, 0};
+  const char *p = resource.c_str() + prefix.size();
+  for (unsigned long &v : values) {
+    if (*p != '/') {
+      break;
+    }
+    char *end = nullptr;
+    v = std::strtoul(p + 1, &end, 10);
+    p = end;
   }
 
-  // reader
-  std::stringstream buf(ptr->get_payload(), std::ios_base::in);
+  *room = values[0];
+  *follow = static_cast<snake_id_t>(values[1]);
+  return *p == '\0';
+}
+
+void GameServer::on_open(connection_hdl hdl) {
+  error_code ec;
+  const WSPPServer::connection_ptr con = endpoint.get_con_from_hdl(hdl, ec);
+  size_t room_id = 0;
+  snake_id_t follow = 0;
+  if (!ec && ParseSpectate(con->get_resource(), &room_id, &follow)) {
+    if (room_id >= rooms.size()) {
+      endpoint.close(hdl, websocketpp::close::status::policy_violation, "No such room", ec);
+      return;
+    }
 
-  in_packet_t packet_type = in_packet_t_angle;
-  buf >> packet_type;
+    Room *room = rooms[room_id].get();
+    if (spectators[room_id] >= config.max_spectators) {
+      endpoint.close(hdl, websocketpp::close::status::try_again_later, "No place to watch", ec);
+      room->RejectSpectator();
+      log.Write(room->GetId(), &log_no_spectator_place);
+      return;
+    }
 
-  // len check
-  const size_t len = ptr->get_payload().size();
-  if (len > 255) {
-    endpoint.get_alog().write(alevel::app,
-        "Packet '" + std::to_string(packet_type) + "' too big " + std::to_string(len));
+    watching[hdl] = room;
+    spectators[room_id]++;
+    room->Spectate(hdl, follow);
     return;
   }
 
-  // session obtain
-  const auto ses_i = sessions.find(hdl);
-  if (ses_i == sessions.end()) {
-    endpoint.get_alog().write(alevel::app, "No session, skip packet");
+  // above the fair share the player will likely land on another worker with
+  // the next connection attempt
+  Room *room = IsOverShare() ? nullptr : AssignRoom();
+  if (room == nullptr) {
+    endpoint.close(hdl, websocketpp::close::status::try_again_later, "No place", ec);
+    log.Write(AsyncLog::no_room, &log_no_place);
     return;
   }
 
-  // last client time manage
-  Session &ss = ses_i->second;
+  assigned[hdl] = room;
+  players[room->GetId()]++;
+  room->Open(hdl);
+}
 
-  // parsing
-  if (packet_type <= 250 && len == 1) {
-    // in_packet_t_angle, [0 - 250]
-    const float angle = Math::f_pi * packet_type / 125.0f;
-    DoSnake(ss.snake_id, [=](Snake *s) {
-      s->wangle = angle;
-      s->update |= change_wangle;
-    });
+void GameServer::on_message(connection_hdl hdl, message_ptr ptr) {
+  const auto room_i = assigned.find(hdl);
+  if (room_i == assigned.end()) {
+    // spectators have no input
+    if (watching.find(hdl) == watching.end()) {
+      log.Write(AsyncLog::no_room, &log_no_room);
+    }
     return;
   }
 
-  switch (packet_type) {
-    case in_packet_t_ping:
-      send_binary(ses_i, packet_pong());
-      break;
-
-    case in_packet_t_username_skin:
-      buf >> ss.protocol_version;
-      buf >> ss.skin;
-      buf.str(ss.name);
-
-      DoSnake(ss.snake_id, [&ss](Snake *s) {
-        s->name = ss.name;
-        s->skin = ss.skin;
-      });
-      break;
-
-    case in_packet_t_victory_message:
-      buf >> packet_type;  // always 118
-      buf.str(ss.message);
-      break;
-
-    case in_packet_t_rot_left:
-      buf >> packet_type;  // vfrb (virtual frames count) [0 - 127] of turning
-                           // into the right direction
-      // snake.eang -= mamu * v * snake.scang * snake.spang)
-      endpoint.get_alog().write(alevel::app,
-          "rotate ccw, snake " + std::to_string(ss.snake_id) + ", vfrb " +
-          std::to_string(packet_type));
-      break;
-
-    case in_packet_t_rot_right:
-      buf >> packet_type;  // vfrb (virtual frames count) [0 - 127] of turning
-                           // into the right direction
-      // snake.eang += mamu * v * snake.scang * snake.spang)
-      endpoint.get_alog().write(alevel::app,
-          "rotate cw, snake " + std::to_string(ss.snake_id) + ", vfrb " +
-          std::to_string(packet_type));
-      break;
-
-    case in_packet_t_start_acc:
-      DoSnake(ss.snake_id, [](Snake *s) { s->acceleration = true; });
-      break;
-
-    case in_packet_t_stop_acc:
-      DoSnake(ss.snake_id, [](Snake *s) { s->acceleration = false; });
-      break;
-
-    default:
-      endpoint.get_alog().write(alevel::app,
-          "Unknown packet type " + std::to_string(packet_type) + ", len " +
-          std::to_string(ptr->get_payload().size()));
-      break;
-  }
+  room_i->second->Message(hdl, ptr);
 }
 
 void GameServer::on_close(connection_hdl hdl) {
-  const auto ptr = sessions.find(hdl);
-  if (ptr != sessions.end()) {
-    const snake_id_t snakeId = ptr->second.snake_id;
-    sessions.erase(ptr->first);
-    RemoveSnake(snakeId);
+  const auto room_i = assigned.find(hdl);
+  if (room_i != assigned.end()) {
+    Room *room = room_i->second;
+    assigned.erase(room_i);
+    players[room->GetId()]--;
+    room->Close(hdl);
+    return;
   }
-}
-
-void GameServer::RemoveSnake(snake_id_t id) {
-  connections.erase(id);
-  world.RemoveSnake(id);
-}
-
-PacketInit GameServer::BuildInitPacket() {
-  PacketInit init_packet;
-
-  init_packet.game_radius = WorldConfig::game_radius;
-  init_packet.max_snake_parts = WorldConfig::max_snake_parts;
-  init_packet.sector_size = WorldConfig::sector_size;
-  init_packet.sector_count_along_edge = WorldConfig::sector_count_along_edge;
-
-  init_packet.spangdv = Snake::spangdv;
-  init_packet.nsp1 = Snake::nsp1;
-  init_packet.nsp2 = Snake::nsp2;
-  init_packet.nsp3 = Snake::nsp3;
-
-  init_packet.snake_ang_speed = 8.0f * Snake::snake_angular_speed / 1000.0f;
-  init_packet.prey_ang_speed = 8.0f * Snake::prey_angular_speed / 1000.0f;
-  init_packet.snake_tail_k = Snake::snake_tail_k;
-
-  init_packet.protocol_version = WorldConfig::protocol_version;
 
-  return init_packet;
+  const auto watch_i = watching.find(hdl);
+  if (watch_i != watching.end()) {
+    spectators[watch_i->second->GetId()]--;
+    watch_i->second->Close(hdl);
+    watching.erase(watch_i);
+  }
 }
 
-long GameServer::GetCurrentTime() {
-  using std::chrono::milliseconds;
-  using std::chrono::duration_cast;
-  using std::chrono::steady_clock;
-
-  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
-}
+void GameServer::on_http(connection_hdl hdl) {
+  const WSPPServer::connection_ptr con = endpoint.get_con_from_hdl(hdl);
 
-void GameServer::DoSnake(snake_id_t id, std::function<void(Snake *)> f) {
-  if (id > 0) {
-    const auto snake_i = world.GetSnake(id);
-    if (snake_i->first == id) {
-      f(snake_i->second.get());
-    }
+  if (con->get_resource() != "/metrics") {
+    con->set_status(websocketpp::http::status_code::not_found);
+    return;
   }
-}
 
-GameServer::SessionMap::iterator GameServer::LoadSessionIter(
-    snake_id_t id) {
-  const auto hdl_i = connections.find(id);
-  if (hdl_i == connections.end()) {
-    endpoint.get_alog().write(alevel::app,
-        "Failed to locate snake connection " + std::to_string(id));
-    return sessions.end();
+  RoomMetrics room_metrics;
+  for (auto &room : rooms) {
+    room_metrics.push_back(&room->GetMetrics());
   }
 
-  const auto ses_i = sessions.find(hdl_i->second);
-  if (ses_i == sessions.end()) {
-    endpoint.get_alog().write(alevel::app,
-        "Failed to locate snake session " + std::to_string(id));
-  }
+  std::stringstream s;
+  WriteMetrics(s, room_metrics);
 
-  return ses_i;
+  con->set_status(websocketpp::http::status_code::ok);
+  con->append_header("Content-Type", "text/plain; version=0.0.4");
+  con->set_body(s.str());
 }
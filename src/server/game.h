@@ -1,114 +1,96 @@
 #ifndef SRC_SERVER_GAME_H_
 #define SRC_SERVER_GAME_H_
 
-#include <chrono>
+#include <boost/asio/local/datagram_protocol.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/strand.hpp>
+
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "server/async_log.h"
+#include "server/control.h"
+#include "server/room.h"
 #include "server/server.h"
-
-#include "game/world.h"
-
-#include "packet/d_all.h"
-#include "packet/p_all.h"
+#include "server/tls.h"
 
 using websocketpp::lib::placeholders::_1;
 using websocketpp::lib::placeholders::_2;
 using websocketpp::lib::bind;
 
-struct Session {
-  snake_id_t snake_id = 0;
-  long last_packet_time = 0;
-
-  std::string name;
-  std::string message;
-
-  uint8_t protocol_version = 0;  // current 8
-  uint8_t skin = 0;              // 0 - 39
-
-  Session() = default;
-  Session(snake_id_t id, long now) : snake_id(id), last_packet_time(now) {}
-};
-
+// Process front: the shared listener, TLS and /metrics. Games run in rooms,
+// each on its own thread. The listener assigns new connections to rooms and
+// forwards connection events to them. In wss mode the endpoint runs on a pool
+// of threads, so handshakes of a join burst run in parallel. The listener
+// state is then only touched on the listener strand.
 class GameServer {
  public:
   GameServer();
 
   int Run(IncomingConfig in_config);
 
-  PacketInit BuildInitPacket();
-
-  typedef std::unordered_map<snake_id_t, connection_hdl> ConnectionMap;
-  typedef std::map<connection_hdl, Session, std::owner_less<connection_hdl>> SessionMap;
-  typedef SessionMap::iterator SessionIter;
+  typedef std::map<connection_hdl, Room *, std::owner_less<connection_hdl>> RoomMap;
 
  private:
   void on_socket_init(connection_hdl, boost::asio::ip::tcp::socket &s);  // NOLINT(runtime/references)
+  error_code on_pre_bind(WSPPServer::acceptor_ptr acceptor);
   websocketpp::lib::shared_ptr<boost::asio::ssl::context> on_tls_init(connection_hdl hdl);
   void on_open(connection_hdl hdl);
   void on_message(connection_hdl hdl, message_ptr ptr);
   void on_close(connection_hdl hdl);
-  void on_timer(error_code const &ec);
+  void on_http(connection_hdl hdl);
+  void on_control_timer(error_code const &ec);
+  void on_control_read(const boost::system::error_code &ec, size_t size);
+  void on_signal(const boost::system::error_code &ec, int signal);
+
+  // least filled room with a free place, nullptr if all are full
+  Room *AssignRoom();
+  void StopRooms();
+  // endpoint threads besides the calling one
+  void StartPool();
+  void JoinPool();
+  // replaces the shared TLS context, the old one is kept on failure
+  bool LoadTls();
+  size_t GetPlayers() const;
+
+  // supervisor channel, when run as a worker
+  void StartControl();
+  // this worker has notably more players than others
+  bool IsOverShare() const;
 
-  void SendPOVUpdateTo(SessionIter ses_i, Snake *ptr);
-  void SendFoodUpdate(Snake *ptr);
-  void BroadcastDebug();
-  void BroadcastUpdates();
-  SessionIter LoadSessionIter(snake_id_t id);
-
-  void DoSnake(snake_id_t id, std::function<void(Snake *)> f);
-  void RemoveSnake(snake_id_t id);
-  void RemoveDeadSnakes();
-
-  long GetCurrentTime();
-  void NextTick(long last);
+ private:
+  WSPPServer endpoint;
+  IncomingConfig config;
+  AsyncLog log;  // outlives the rooms
 
-  void PrintWorldInfo();
+  // SIGINT, SIGTERM stop the server, rooms save their snapshots. SIGHUP
+  // reloads the TLS certificate and key.
+  std::unique_ptr<boost::asio::signal_set> signals;
 
- private:
-  template <typename T>
-  void send_binary(SessionMap::iterator s, T packet) {
-    const long now = GetCurrentTime();
-    const uint16_t interval =
-        static_cast<uint16_t>(now - s->second.last_packet_time);
-    s->second.last_packet_time = now;
-    packet.client_time = interval;
-    endpoint.send_binary(s->first, packet);
-  }
-
-  template <typename T>
-  void broadcast_binary(T packet) {
-    const long now = GetCurrentTime();
-    for (auto &s : sessions) {
-      const uint16_t interval =
-          static_cast<uint16_t>(now - s.second.last_packet_time);
-      s.second.last_packet_time = now;
-      packet.client_time = interval;
-      endpoint.send_binary(s.first, packet);
-    }
-  }
-
-  template <typename T>
-  void broadcast_debug(T packet) {
-    for (auto &s : sessions) {
-      endpoint.send_binary(s.first, packet);
-    }
-  }
+  // swapped atomically, a connection keeps the context it started with
+  TlsContextPtr tls;
 
-  WSPPServer endpoint;
+  std::vector<std::unique_ptr<Room>> rooms;
 
-  WSPPServer::timer_ptr timer;
-  long last_time_point;
-  static const long timer_interval_ms = 10;
+  std::unique_ptr<boost::asio::io_service::strand> listener;
+  std::vector<std::thread> pool;
 
-  World world;
-  PacketInit init;
-  IncomingConfig config;
+  // listener strand only
+  std::vector<size_t> players;  // by room id
+  RoomMap assigned;
+  RoomMap watching;  // spectators, not counted as players
+  std::vector<size_t> spectators;  // by room id, up to max_spectators
 
-  // TODO(john.koepi): reserve to collections
-  SessionMap sessions;
-  ConnectionMap connections;
+  typedef boost::asio::local::datagram_protocol::socket ControlSocket;
+  std::unique_ptr<ControlSocket> control;
+  WSPPServer::timer_ptr control_timer;
+  ControlState control_buf;
+  ControlState cluster;  // the last totals of all workers
+  static const long control_interval_ms = 1000;
+  static const size_t share_slack = 4;  // players over the fair share
 };
 
 #endif  // SRC_SERVER_GAME_H_
@@ -1,5 +1,11 @@
 #include "server/game.h"
+#include "server/supervisor.h"
 
 int main(const int argc, const char* const argv[]) {
-  return std::unique_ptr<GameServer>(new GameServer())->Run(ParseCommandLine(argc, argv));
+  const IncomingConfig config = ParseCommandLine(argc, argv);
+  if (config.workers > 0) {
+    return Supervisor(config).Run();
+  }
+
+  return std::unique_ptr<GameServer>(new GameServer())->Run(config);
 }
@@ -0,0 +1,127 @@
+#include "server/metrics.h"
+
+#include <string>
+
+static const std::memory_order relaxed = std::memory_order_relaxed;
+
+void ServerMetrics::Publish(const TickProfiler &profiler) {
+  for (uint8_t i = 0; i < phase_count; i++) {
+    const tick_phase_t phase = static_cast<tick_phase_t>(i);
+    const Histogram &h = profiler.Get(phase);
+    PhaseMetrics &m = phases[i];
+
+    m.p50.store(h.GetPercentile(0.5), relaxed);
+    m.p99.store(h.GetPercentile(0.99), relaxed);
+    m.p999.store(h.GetPercentile(0.999), relaxed);
+    m.max.store(h.GetMax(), relaxed);
+    m.count.store(profiler.GetTotalCount(phase), relaxed);
+    m.sum.store(profiler.GetTotalSum(phase), relaxed);
+  }
+}
+
+static void Store(PacketMetrics *m, const PacketCounter &c) {
+  m->frames.store(c.frames, relaxed);
+  m->bytes.store(c.bytes, relaxed);
+}
+
+void ServerMetrics::Publish(const TrafficStats &traffic) {
+  for (uint8_t i = 0; i < TrafficStats::out_slots; i++) {
+    Store(&out_packets[i], traffic.GetOut(i));
+  }
+  for (uint8_t i = 0; i < TrafficStats::in_slots; i++) {
+    Store(&in_packets[i], traffic.GetIn(i));
+  }
+}
+
+typedef std::atomic<uint64_t> ServerMetrics::*MetricField;
+
+static void WriteMetric(std::ostream &out, const RoomMetrics &rooms, const char *name, const char *type,
+                        const char *help, MetricField field) {
+  out << "# HELP " << name << " " << help << "\n"
+      << "# TYPE " << name << " " << type << "\n";
+  for (size_t r = 0; r < rooms.size(); r++) {
+    out << name << "{room=\"" << r << "\"} " << (rooms[r]->*field).load(relaxed) << "\n";
+  }
+}
+
+// packets is a pointer to a PacketMetrics array member
+template <typename P, typename N>
+static void WritePacketMetrics(std::ostream &out, const RoomMetrics &rooms, const char *dir, P packets,
+                               uint8_t count, N name) {
+  const std::string frames = std::string("slither_") + dir + "_packet_frames_total";
+  const std::string bytes = std::string("slither_") + dir + "_packet_bytes_total";
+
+  out << "# HELP " << frames << " Websocket frames by packet type, " << dir << "bound.\n"
+      << "# TYPE " << frames << " counter\n";
+  for (size_t r = 0; r < rooms.size(); r++) {
+    for (uint8_t i = 0; i < count; i++) {
+      out << frames << "{room=\"" << r << "\",type=\"" << name(i) << "\"} "
+          << (rooms[r]->*packets)[i].frames.load(relaxed) << "\n";
+    }
+  }
+
+  out << "# HELP " << bytes << " Websocket payload bytes by packet type, " << dir << "bound.\n"
+      << "# TYPE " << bytes << " counter\n";
+  for (size_t r = 0; r < rooms.size(); r++) {
+    for (uint8_t i = 0; i < count; i++) {
+      out << bytes << "{room=\"" << r << "\",type=\"" << name(i) << "\"} "
+          << (rooms[r]->*packets)[i].bytes.load(relaxed) << "\n";
+    }
+  }
+}
+
+static double ToSeconds(const std::atomic<uint64_t> &ns) { return ns.load(relaxed) / 1e9; }
+
+void WriteMetrics(std::ostream &out, const RoomMetrics &rooms) {
+  WriteMetric(out, rooms, "slither_snakes", "gauge", "Snakes in the world.", &ServerMetrics::snakes);
+  WriteMetric(out, rooms, "slither_bots", "gauge", "Bot snakes in the world.", &ServerMetrics::bots);
+  WriteMetric(out, rooms, "slither_bots_unseen", "gauge", "Bots out of every player viewport.",
+              &ServerMetrics::bots_unseen);
+  WriteMetric(out, rooms, "slither_sessions", "gauge", "Connected player sessions.", &ServerMetrics::sessions);
+  WriteMetric(out, rooms, "slither_spectators", "gauge", "Connected spectators.", &ServerMetrics::spectators);
+  WriteMetric(out, rooms, "slither_spectators_rejected_total", "counter",
+              "Spectators turned away over the room limit.", &ServerMetrics::spectators_rejected);
+  WriteMetric(out, rooms, "slither_food", "gauge", "Food items in the world.", &ServerMetrics::food);
+  WriteMetric(out, rooms, "slither_ticks_total", "counter", "Game loop steps.", &ServerMetrics::ticks);
+  WriteMetric(out, rooms, "slither_bot_decisions_total", "counter", "Bot decisions made.",
+              &ServerMetrics::bot_decisions);
+  WriteMetric(out, rooms, "slither_out_bytes_total", "counter", "Outbound websocket payload bytes.",
+              &ServerMetrics::out_bytes);
+  WriteMetric(out, rooms, "slither_out_frames_total", "counter", "Outbound websocket frames.",
+              &ServerMetrics::out_frames);
+  WriteMetric(out, rooms, "slither_out_bytes_per_second", "gauge",
+              "Outbound payload bytes per second over the last publish interval.",
+              &ServerMetrics::out_bytes_per_second);
+  WriteMetric(out, rooms, "slither_out_frames_per_second", "gauge",
+              "Outbound frames per second over the last publish interval.", &ServerMetrics::out_frames_per_second);
+  WriteMetric(out, rooms, "slither_send_queue_bytes", "gauge",
+              "Outbound bytes buffered by all connections.", &ServerMetrics::send_queue_bytes);
+  WriteMetric(out, rooms, "slither_send_queue_max_bytes", "gauge",
+              "Outbound bytes buffered by the most lagging connection.", &ServerMetrics::send_queue_max_bytes);
+  WriteMetric(out, rooms, "slither_log_dropped_total", "counter", "Application log messages dropped.",
+              &ServerMetrics::log_dropped);
+
+  WritePacketMetrics(out, rooms, "out", &ServerMetrics::out_packets, TrafficStats::out_slots,
+                     TrafficStats::GetOutName);
+  WritePacketMetrics(out, rooms, "in", &ServerMetrics::in_packets, TrafficStats::in_slots,
+                     TrafficStats::GetInName);
+
+  static const char *const name = "slither_tick_phase_seconds";
+  out << "# HELP " << name << " Game loop step phase durations.\n"
+      << "# TYPE " << name << " summary\n";
+
+  for (size_t r = 0; r < rooms.size(); r++) {
+    for (uint8_t i = 0; i < phase_count; i++) {
+      const PhaseMetrics &p = rooms[r]->phases[i];
+      const std::string labels = "room=\"" + std::to_string(r) + "\",phase=\"" +
+                                 TickProfiler::GetName(static_cast<tick_phase_t>(i)) + "\"";
+
+      out << name << "{" << labels << ",quantile=\"0.5\"} " << ToSeconds(p.p50) << "\n"
+          << name << "{" << labels << ",quantile=\"0.99\"} " << ToSeconds(p.p99) << "\n"
+          << name << "{" << labels << ",quantile=\"0.999\"} " << ToSeconds(p.p999) << "\n"
+          << name << "{" << labels << ",quantile=\"1\"} " << ToSeconds(p.max) << "\n"
+          << name << "_sum{" << labels << "} " << ToSeconds(p.sum) << "\n"
+          << name << "_count{" << labels << "} " << p.count.load(relaxed) << "\n";
+    }
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef SRC_SERVER_METRICS_H_
+#define SRC_SERVER_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "server/profiler.h"
+#include "server/traffic.h"
+
+// Tick phase timings as published for scraping, ns.
+struct PhaseMetrics {
+  std::atomic<uint64_t> p50{0};
+  std::atomic<uint64_t> p99{0};
+  std::atomic<uint64_t> p999{0};
+  std::atomic<uint64_t> max{0};
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum{0};
+};
+
+struct PacketMetrics {
+  std::atomic<uint64_t> frames{0};
+  std::atomic<uint64_t> bytes{0};
+};
+
+// Server metrics of a room exposed at /metrics in Prometheus text format. The
+// room game loop publishes values periodically, the listener only increments
+// its own counters. Scrapes only read relaxed atomics and never touch the
+// world or take a lock.
+struct ServerMetrics {
+  std::atomic<uint64_t> snakes{0};
+  std::atomic<uint64_t> bots{0};
+  std::atomic<uint64_t> bots_unseen{0};
+  std::atomic<uint64_t> sessions{0};
+  std::atomic<uint64_t> spectators{0};
+  std::atomic<uint64_t> spectators_rejected{0};  // by the listener, over max_spectators
+  std::atomic<uint64_t> food{0};
+
+  std::atomic<uint64_t> ticks{0};
+  std::atomic<uint64_t> bot_decisions{0};
+
+  std::atomic<uint64_t> out_bytes{0};
+  std::atomic<uint64_t> out_frames{0};
+  std::atomic<uint64_t> out_bytes_per_second{0};
+  std::atomic<uint64_t> out_frames_per_second{0};
+
+  // outgoing bytes buffered by connections, not yet written to sockets
+  std::atomic<uint64_t> send_queue_bytes{0};
+  std::atomic<uint64_t> send_queue_max_bytes{0};
+
+  // rate limited or the log ring was full
+  std::atomic<uint64_t> log_dropped{0};
+
+  PhaseMetrics phases[phase_count];
+
+  // by TrafficStats slot
+  PacketMetrics out_packets[TrafficStats::out_slots];
+  PacketMetrics in_packets[TrafficStats::in_slots];
+
+  void Publish(const TickProfiler &profiler);
+  void Publish(const TrafficStats &traffic);
+};
+
+// by room id, every value is labeled with its room
+typedef std::vector<const ServerMetrics *> RoomMetrics;
+
+void WriteMetrics(std::ostream &out, const RoomMetrics &rooms);
+
+#endif  // SRC_SERVER_METRICS_H_
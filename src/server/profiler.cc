@@ -0,0 +1,117 @@
+#include "server/profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+
+void Histogram::Record(uint64_t v) {
+  buckets[GetIndex(v)]++;
+  count++;
+  sum += v;
+  max = std::max(max, v);
+}
+
+void Histogram::Reset() { *this = Histogram(); }
+
+uint64_t Histogram::GetCount() const { return count; }
+
+uint64_t Histogram::GetMax() const { return max; }
+
+uint64_t Histogram::GetMean() const { return count > 0 ? sum / count : 0; }
+
+uint64_t Histogram::GetPercentile(double q) const {
+  if (count == 0) {
+    return 0;
+  }
+
+  const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.5));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < bucket_count; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return std::min(GetUpperBound(i), max);
+    }
+  }
+
+  return max;
+}
+
+size_t Histogram::GetIndex(uint64_t v) {
+  static const uint64_t limit = (1ull << max_bits) - 1;
+  v = std::min(v, limit);
+
+  if (v < sub_count) {
+    return static_cast<size_t>(v);
+  }
+
+  // v in [2^e, 2^(e+1)), keep top sub_bits + 1 bits
+  int e = sub_bits;
+  while ((v >> (e + 1)) != 0) {
+    e++;
+  }
+  const int shift = e - sub_bits;
+
+  return static_cast<size_t>((shift + 1) * sub_count + ((v >> shift) - sub_count));
+}
+
+uint64_t Histogram::GetUpperBound(size_t index) {
+  if (index < sub_count) {
+    return index;
+  }
+
+  const int shift = static_cast<int>(index / sub_count) - 1;
+  const uint64_t sub = index % sub_count + sub_count;
+  return ((sub + 1) << shift) - 1;
+}
+
+uint64_t TickProfiler::Now() {
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  return duration_cast<nanoseconds>(clock::now().time_since_epoch()).count();
+}
+
+void TickProfiler::Record(tick_phase_t phase, uint64_t ns) {
+  phases[phase].Record(ns);
+  total_count[phase]++;
+  total_sum[phase] += ns;
+}
+
+void TickProfiler::Reset() {
+  for (Histogram &h : phases) {
+    h.Reset();
+  }
+}
+
+const Histogram &TickProfiler::Get(tick_phase_t phase) const { return phases[phase]; }
+
+uint64_t TickProfiler::GetTotalCount(tick_phase_t phase) const { return total_count[phase]; }
+
+uint64_t TickProfiler::GetTotalSum(tick_phase_t phase) const { return total_sum[phase]; }
+
+const char *TickProfiler::GetName(tick_phase_t phase) {
+  static const char *const names[phase_count] = {
+      "tick", "jitter", "world", "ai", "snakes", "bounds", "debug", "updates", "dead", "spectate"};
+  return names[phase];
+}
+
+std::ostream &operator<<(std::ostream &out, const TickProfiler &p) {
+  out << "Tick profile, us: phase count p50 p99 p999 max";
+
+  for (uint8_t i = 0; i < phase_count; i++) {
+    const tick_phase_t phase = static_cast<tick_phase_t>(i);
+    const Histogram &h = p.Get(phase);
+    if (h.GetCount() == 0) {
+      continue;
+    }
+
+    out << "\n  " << std::left << std::setw(8) << TickProfiler::GetName(phase) << std::right
+        << std::fixed << std::setprecision(1)
+        << " " << h.GetCount()
+        << " " << h.GetPercentile(0.5) / 1000.0
+        << " " << h.GetPercentile(0.99) / 1000.0
+        << " " << h.GetPercentile(0.999) / 1000.0
+        << " " << h.GetMax() / 1000.0;
+  }
+
+  return out;
+}
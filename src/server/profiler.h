@@ -0,0 +1,79 @@
+#ifndef SRC_SERVER_PROFILER_H_
+#define SRC_SERVER_PROFILER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Log-linear (HDR style) histogram of nanosecond values. Every power of two
+// range is split into sub_count linear buckets, so the relative error of a
+// reported value is below 1 / sub_count. Values up to 2^max_bits ns (~4.5
+// minutes) are tracked, larger ones are clamped. Recording is a few integer
+// ops with no allocation.
+class Histogram {
+ public:
+  void Record(uint64_t v);
+  void Reset();
+
+  uint64_t GetCount() const;
+  uint64_t GetMax() const;
+  uint64_t GetMean() const;
+  // highest value equivalent to the bucket holding the given quantile [0, 1]
+  uint64_t GetPercentile(double q) const;
+
+ private:
+  static size_t GetIndex(uint64_t v);
+  static uint64_t GetUpperBound(size_t index);
+
+  static const int sub_bits = 5;
+  static const uint64_t sub_count = 1 << sub_bits;
+  static const int max_bits = 38;
+  static const size_t bucket_count = (max_bits - sub_bits + 1) * sub_count;
+
+  uint64_t buckets[bucket_count] = {};
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+};
+
+enum tick_phase_t : uint8_t {
+  phase_tick = 0,    // whole on_timer step
+  phase_jitter,      // actual minus scheduled timer wake up
+  phase_world,       // World::Tick
+  phase_ai,          // bot decisions
+  phase_snakes,      // snakes movement
+  phase_bounds,      // CheckSnakeBounds
+  phase_debug,       // BroadcastDebug
+  phase_updates,     // BroadcastUpdates
+  phase_dead,        // RemoveDeadSnakes
+  phase_spectate,    // FlushSpectators, at the spectator rate
+  phase_count
+};
+
+// Always on game loop profiler, a histogram per phase of the tick.
+class TickProfiler {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+  static uint64_t Now();
+
+  void Record(tick_phase_t phase, uint64_t ns);
+  void Reset();
+
+  const Histogram &Get(tick_phase_t phase) const;
+  // since start, not affected by Reset
+  uint64_t GetTotalCount(tick_phase_t phase) const;
+  uint64_t GetTotalSum(tick_phase_t phase) const;
+
+  static const char *GetName(tick_phase_t phase);
+
+ private:
+  Histogram phases[phase_count];
+  uint64_t total_count[phase_count] = {};
+  uint64_t total_sum[phase_count] = {};
+};
+
+// per phase p50/p99/p999/max in microseconds
+std::ostream &operator<<(std::ostream &out, const TickProfiler &p);
+
+#endif  // SRC_SERVER_PROFILER_H_
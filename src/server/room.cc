@@ -0,0 +1,796 @@
+#include "server/room.h"
+
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+
+// per client input or per death, rate limited
+static LogSite log_dying("Found dying snake %lld");
+static LogSite log_bad_opcode("Unknown incoming message opcode %lld");
+static LogSite log_too_big("Packet '%lld' too big %lld");
+static LogSite log_no_session("No session, skip packet");
+static LogSite log_rotate_ccw("rotate ccw, snake %lld, vfrb %lld");
+static LogSite log_rotate_cw("rotate cw, snake %lld, vfrb %lld");
+static LogSite log_bad_packet("Unknown packet type %lld, len %lld");
+static LogSite log_no_connection("Failed to locate snake connection %lld");
+static LogSite log_no_snake_session("Failed to locate snake session %lld");
+static LogSite log_input_flood("Input flood, snake %lld sent over the per tick input count");
+static LogSite log_overload("Load is too high, step took %lldms");
+
+Room::Room(WSPPServer *server, AsyncLog *in_log, uint16_t in_room_id)
+    : endpoint(*server), log(*in_log), room_id(in_room_id), timer(service) {}
+
+void Room::Start(const IncomingConfig &in_config) {
+  config = in_config;
+
+  const bool restored = InitWorld();
+  init = BuildInitPacket();
+
+  if (restored && !config.journal_file.empty()) {
+    Log("Journal is not recorded for a world restored from a snapshot");
+  } else if (!config.journal_file.empty()) {
+    WorldConfig journal_config = config.world;
+    journal_config.seed = world.GetSeed();
+    if (journal.Open(config.journal_file, journal_config)) {
+      Log("Recording journal to " + config.journal_file + ", seed " + std::to_string(journal_config.seed));
+    } else {
+      endpoint.get_elog().write(elevel::fatal, "Failed to open journal " + config.journal_file);
+    }
+  }
+
+  if (room_id == 0) {
+    PrintWorldInfo();
+  }
+
+  last_stats_time = GetCurrentTime();
+  last_metrics_time = last_stats_time;
+  last_snapshot_time = last_stats_time;
+  last_spectator_time = last_stats_time;
+  NextTick(last_stats_time);
+
+  work.reset(new boost::asio::io_service::work(service));
+  thread = std::thread([this]() { service.run(); });
+}
+
+void Room::Stop() {
+  service.post([this]() { service.stop(); });
+
+  if (thread.joinable()) {
+    thread.join();
+  }
+  journal.Close();
+  SaveSnapshot();
+}
+
+bool Room::InitWorld() {
+  SnapshotFile snapshot;
+  if (config.snapshot_file.empty() || !snapshot.Open(config.snapshot_file)) {
+    world.Init(config.world);
+    return false;
+  }
+
+  const long start = GetCurrentTime();
+  world.Init(config.world, snapshot);
+
+  const SnapshotHeader &h = snapshot.GetHeader();
+  Log("Restored world from " + config.snapshot_file + " in " + std::to_string(GetCurrentTime() - start) +
+      "ms, " + std::to_string(h.snake_count) + " bots, " + std::to_string(h.food_count) + " food, seed " +
+      std::to_string(h.seed));
+  return true;
+}
+
+void Room::SaveSnapshot() {
+  if (config.snapshot_file.empty()) {
+    return;
+  }
+
+  const long start = GetCurrentTime();
+  if (WriteSnapshot(&world, config.snapshot_file)) {
+    Log("Saved snapshot " + config.snapshot_file + " in " + std::to_string(GetCurrentTime() - start) + "ms");
+  } else {
+    endpoint.get_elog().write(elevel::warn, "Failed to save snapshot " + config.snapshot_file);
+  }
+}
+
+void Room::Open(connection_hdl hdl) {
+  service.post([this, hdl]() { on_open(hdl); });
+}
+
+void Room::Message(connection_hdl hdl, message_ptr ptr) {
+  service.post([this, hdl, ptr]() { on_message(hdl, ptr); });
+}
+
+void Room::Close(connection_hdl hdl) {
+  service.post([this, hdl]() { on_close(hdl); });
+}
+
+void Room::Spectate(connection_hdl hdl, snake_id_t follow) {
+  service.post([this, hdl, follow]() { on_spectate(hdl, follow); });
+}
+
+void Room::RejectSpectator() { metrics.spectators_rejected.fetch_add(1, std::memory_order_relaxed); }
+
+uint16_t Room::GetId() const { return room_id; }
+
+const ServerMetrics &Room::GetMetrics() const { return metrics; }
+
+void Room::Log(const std::string &message) {
+  if (!log.Write(room_id, message)) {
+    metrics.log_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void Room::Log(LogSite *site, long long a, long long b, long long c) {
+  if (!log.Write(room_id, site, a, b, c)) {
+    metrics.log_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void Room::PrintWorldInfo() {
+  std::stringstream s;
+  s << "World info = \n" << world;
+  Log(s.str());
+}
+
+void Room::PrintStats(long interval) {
+  BotStats &bs = world.GetBotStats();
+  if (bs.bots > 0) {
+    const uint64_t per_decision = bs.decisions > 0 ? bs.time_ns / bs.decisions : 0;
+    const uint64_t per_bot = bs.time_ns * 1000 / bs.bots / std::max(1L, interval);
+
+    std::stringstream s;
+    s << "Bots " << bs.bots << " (unseen " << world.GetUnseenCount() << ")"
+      << ", decisions " << bs.decisions
+      << ", budget hits " << bs.budget_hits
+      << ", cpu " << bs.time_ns / 1000 << "us"
+      << ", " << per_decision << "ns/decision"
+      << ", " << per_bot << "ns/bot/s";
+    Log(s.str());
+  }
+  bs.Reset();
+
+  PrintTraffic(interval);
+
+  std::stringstream p;
+  p << profiler;
+  Log(p.str());
+  profiler.Reset();
+}
+
+void Room::PrintTraffic(long interval) {
+  const TrafficStats recent = traffic.Since(last_traffic);
+  last_traffic = traffic;
+
+  std::stringstream s;
+  s << "Traffic " << interval << "ms, " << recent;
+  Log(s.str());
+
+  // the most expensive session over the interval
+  const Session *top = nullptr;
+  uint64_t top_bytes = 0;
+  for (auto &i : sessions) {
+    Session &ss = i.second;
+    const uint64_t bytes = ss.traffic.GetOutTotal().bytes - ss.last_out_bytes;
+    ss.last_out_bytes = ss.traffic.GetOutTotal().bytes;
+    if (bytes > top_bytes) {
+      top_bytes = bytes;
+      top = &ss;
+    }
+  }
+
+  if (top != nullptr) {
+    std::stringstream t;
+    t << "Top session snake " << top->snake_id << ", " << top_bytes * 1000 / std::max(1L, interval)
+      << " bytes/s, since connect " << top->traffic;
+    Log(t.str());
+  }
+}
+
+void Room::PublishMetrics(long interval) {
+  static const std::memory_order relaxed = std::memory_order_relaxed;
+
+  const BotStats &bs = world.GetBotStats();
+  metrics.snakes.store(world.GetSnakes().size(), relaxed);
+  metrics.bots.store(bs.bots, relaxed);
+  metrics.bots_unseen.store(world.GetUnseenCount(), relaxed);
+  metrics.bot_decisions.store(bs.total_decisions, relaxed);
+  metrics.sessions.store(sessions.size(), relaxed);
+  metrics.spectators.store(spectators.size(), relaxed);
+
+  metrics.food.store(world.GetSectors().get_food_arena().get_size(), relaxed);
+
+  const uint64_t out_bytes = traffic.GetOutTotal().bytes;
+  const uint64_t out_frames = traffic.GetOutTotal().frames;
+  metrics.out_bytes.store(out_bytes, relaxed);
+  metrics.out_frames.store(out_frames, relaxed);
+  metrics.out_bytes_per_second.store((out_bytes - last_out_bytes) * 1000 / std::max(1L, interval), relaxed);
+  metrics.out_frames_per_second.store((out_frames - last_out_frames) * 1000 / std::max(1L, interval), relaxed);
+  last_out_bytes = out_bytes;
+  last_out_frames = out_frames;
+
+  size_t queued = 0;
+  size_t queued_max = 0;
+  for (auto &s : sessions) {
+    error_code ec;
+    const WSPPServer::connection_ptr con = endpoint.get_con_from_hdl(s.first, ec);
+    if (!ec) {
+      const size_t amount = con->get_buffered_amount();
+      queued += amount;
+      queued_max = std::max(queued_max, amount);
+    }
+  }
+  metrics.send_queue_bytes.store(queued, relaxed);
+  metrics.send_queue_max_bytes.store(queued_max, relaxed);
+
+  metrics.Publish(profiler);
+  metrics.Publish(traffic);
+}
+
+void Room::NextTick(long last) {
+  last_time_point = last;
+  const long delay = std::max(0L, timer_interval_ms - (GetCurrentTime() - last));
+  next_wake_ns = TickProfiler::Now() + delay * 1000000;
+  timer.expires_from_now(std::chrono::milliseconds(delay));
+  timer.async_wait([this](const boost::system::error_code &ec) { on_timer(ec); });
+}
+
+void Room::on_timer(const boost::system::error_code &ec) {
+  const uint64_t start_ns = TickProfiler::Now();
+  const long now = GetCurrentTime();
+  const long dt = now - last_time_point;
+
+  if (ec == boost::asio::error::operation_aborted) {
+    return;
+  }
+
+  if (ec) {
+    Log("Main game loop timer error: " + ec.message());
+    return;
+  }
+
+  profiler.Record(phase_jitter, start_ns > next_wake_ns ? start_ns - next_wake_ns : 0);
+
+  journal.Tick(dt);
+  world.Tick(dt);
+  const uint64_t world_ns = TickProfiler::Now();
+  const TickStats &ts = world.GetTickStats();
+  profiler.Record(phase_world, world_ns - start_ns);
+  if (ts.frames > 0) {
+    profiler.Record(phase_ai, ts.ai_ns);
+    profiler.Record(phase_snakes, ts.snakes_ns);
+    profiler.Record(phase_bounds, ts.bounds_ns);
+  }
+
+  BroadcastDebug();
+  const uint64_t debug_ns = TickProfiler::Now();
+  profiler.Record(phase_debug, debug_ns - world_ns);
+
+  BroadcastUpdates();
+  const uint64_t updates_ns = TickProfiler::Now();
+  profiler.Record(phase_updates, updates_ns - debug_ns);
+
+  RemoveDeadSnakes();
+  uint64_t end_ns = TickProfiler::Now();
+  profiler.Record(phase_dead, end_ns - updates_ns);
+
+  if (!spectators.empty() && now - last_spectator_time >= spectator_interval_ms) {
+    FlushSpectators(now);
+    const uint64_t dead_ns = end_ns;
+    end_ns = TickProfiler::Now();
+    profiler.Record(phase_spectate, end_ns - dead_ns);
+  }
+  profiler.Record(phase_tick, end_ns - start_ns);
+
+  metrics.ticks.fetch_add(1, std::memory_order_relaxed);
+  if (now - last_metrics_time >= metrics_interval_ms) {
+    PublishMetrics(now - last_metrics_time);
+    last_metrics_time = now;
+  }
+
+  if (config.snapshot_interval > 0 && now - last_snapshot_time >= config.snapshot_interval * 1000L) {
+    SaveSnapshot();
+    last_snapshot_time = now;
+  }
+
+  if (now - last_stats_time >= stats_interval_ms) {
+    PrintStats(now - last_stats_time);
+    journal.Flush();
+    last_stats_time = now;
+  }
+
+  const long step_time = GetCurrentTime() - now;
+  if (step_time > 10) {
+    Log(&log_overload, step_time);
+  }
+
+  NextTick(now);
+}
+
+void Room::BroadcastDebug() {
+  if (!config.debug) {
+    return;
+  }
+
+  packet_debug_draw draw;
+
+  for (Snake *s : world.GetChangedSnakes()) {
+    uint16_t sis = static_cast<uint16_t>(s->id * 1000);
+
+    // bound box
+    draw.circles.push_back(
+        d_draw_circle{sis++, {s->sbb.x, s->sbb.y}, s->sbb.r, 0xc8c8c8});
+
+    // body inner circles
+    const float r1 = s->get_snake_body_part_radius();
+
+    draw.circles.push_back(
+        d_draw_circle{sis++, {s->get_head_x(), s->get_head_y()}, r1, 0xc80000});
+
+    const Body &sec = *(s->parts.begin() + 1);
+    draw.circles.push_back(d_draw_circle{sis++, {sec.x, sec.y}, r1, 0x3c3c3c});
+    draw.circles.push_back(
+        d_draw_circle{sis++,
+                      {sec.x + (s->get_head_x() - sec.x) / 2.0f,
+                       sec.y + (s->get_head_y() - sec.y) / 2.0f},
+                      r1,
+                      0x646464});
+    draw.circles.push_back(d_draw_circle{
+        sis++, {s->parts.back().x, s->parts.back().y}, r1, 0x646464});
+
+    // bounds
+    for (const Sector *ss : s->sbb.sectors) {
+      draw.circles.push_back(
+          d_draw_circle{sis++, {ss->box.x, ss->box.y}, ss->box.r, 0x511883});
+    }
+
+    // intersection algorithm
+    static const size_t head_size = 8;
+    static const size_t tail_step = static_cast<size_t>(
+        WorldConfig::sector_size / Snake::tail_step_distance);
+    static const size_t tail_step_half = tail_step / 2;
+    const size_t len = s->parts.size();
+
+    if (len <= head_size + tail_step) {
+      for (const Body &b : s->parts) {
+        draw.circles.push_back(d_draw_circle{
+            sis++, {b.x, b.y}, WorldConfig::move_step_distance, 0x646464});
+      }
+    } else {
+      auto p = s->parts[3];
+      draw.circles.push_back(d_draw_circle{
+          sis++, {p.x, p.y}, WorldConfig::sector_size / 2, 0x848484});
+      p = s->parts[0];
+      draw.circles.push_back(d_draw_circle{
+          sis++, {p.x, p.y}, WorldConfig::move_step_distance, 0x646464});
+      p = s->parts[8];
+      draw.circles.push_back(d_draw_circle{
+          sis++, {p.x, p.y}, WorldConfig::move_step_distance, 0x646464});
+
+      auto end = s->parts.end();
+      for (auto i = s->parts.begin() + 7 + tail_step_half; i < end; i += tail_step) {
+        draw.circles.push_back(d_draw_circle{
+            sis++, {i->x, i->y}, WorldConfig::sector_size / 2, 0x848484});
+      }
+    }
+  }
+
+  if (!draw.empty()) {
+    broadcast_debug(draw);
+  }
+}
+
+void Room::BroadcastUpdates() {
+  for (auto ptr : world.GetChangedSnakes()) {
+    const snake_id_t id = ptr->id;
+    const uint8_t flags = ptr->state->update;
+
+    if (flags & change_dead) {
+      continue;
+    }
+
+    if (flags & change_dying) {
+      Log(&log_dying, id);
+
+      if (!ptr->bot) {
+        const auto ses_i = LoadSessionIter(id);
+        if (ses_i != sessions.end()) {
+          send_binary(ses_i, packet_end(packet_end::status_death));
+        }
+      }
+
+      ptr->on_dead_food_spawn(&world.GetSectors(), &world.GetRandom());
+      SendFoodUpdate(ptr);
+
+      broadcast_binary(packet_remove_snake(ptr->id, packet_remove_snake::status_snake_died));
+      broadcast_binary(packet_remove_snake(ptr->id, packet_remove_snake::status_snake_left));
+
+      ptr->state->update |= change_dead;
+
+      if (ptr->bot) {
+        world.GetDead().push_back(ptr->id);
+      }
+
+      continue;
+    }
+
+    if (flags) {
+      if (flags & (change_angle | change_speed)) {
+        packet_rotation rot = packet_rotation();
+        rot.snakeId = id;
+
+        if (flags & change_angle) {
+          ptr->state->update ^= change_angle;
+          rot.ang = ptr->state->angle;
+
+          if (flags & change_wangle) {
+            ptr->state->update ^= change_wangle;
+            rot.wang = ptr->state->wangle;
+          }
+        }
+
+        if (flags & change_speed) {
+          ptr->state->update ^= change_speed;
+          rot.snakeSpeed = ptr->state->speed / 32.0f;
+        }
+
+        broadcast_binary(rot);
+      }
+
+      if (flags & change_pos) {
+        ptr->state->update ^= change_pos;
+
+        // increase length
+        if (ptr->clientPartsIndex < ptr->parts.size()) {
+          broadcast_binary(packet_inc(ptr));
+          ptr->clientPartsIndex++;
+        } else {
+          // decrease length
+          if (ptr->clientPartsIndex > ptr->parts.size()) {
+            broadcast_binary(packet_remove_part(ptr));
+            ptr->clientPartsIndex--;
+          }
+
+          // move
+          broadcast_binary(packet_move(ptr));
+        }
+
+        SendFoodUpdate(ptr);
+        if (!ptr->bot) {
+          const auto ses_i = LoadSessionIter(id);
+          SendPOVUpdateTo(ses_i, ptr);
+
+          if (flags & change_fullness) {
+            send_binary(ses_i, packet_fullness(ptr));
+            ptr->state->update ^= change_fullness;
+          }
+        }
+      }
+    }
+  }
+
+  world.FlushChanges();
+}
+
+void Room::SendPOVUpdateTo(SessionIter ses_i, Snake *ptr) {
+  ptr->vp.CollectChanges(&world.GetSectors());
+
+  if (!ptr->vp.new_sectors.empty()) {
+    for (const Sector *s_ptr : ptr->vp.new_sectors) {
+      send_binary(ses_i, packet_add_sector(s_ptr->x, s_ptr->y));
+      send_binary(ses_i, packet_set_food(s_ptr));
+    }
+    ptr->vp.new_sectors.clear();
+  }
+
+  if (!ptr->vp.old_sectors.empty()) {
+    for (const Sector *s_ptr : ptr->vp.old_sectors) {
+      send_binary(ses_i, packet_remove_sector(s_ptr->x, s_ptr->y));
+    }
+    ptr->vp.old_sectors.clear();
+  }
+}
+
+void Room::SendFoodUpdate(Snake *ptr) {
+  if (!ptr->eaten.empty()) {
+    const snake_id_t id = ptr->id;
+    for (const Food &f : ptr->eaten) {
+      // TODO(john.koepi): to those who observers me
+      broadcast_binary(packet_eat_food(id, f));
+    }
+    ptr->eaten.clear();
+  }
+
+  if (!ptr->spawn.empty()) {
+    for (const Food &f : ptr->spawn) {
+      // TODO(john.koepi): to those who observers me
+      broadcast_binary(packet_spawn_food(f));
+    }
+    ptr->spawn.clear();
+  }
+}
+
+void Room::RemoveDeadSnakes() {
+  for (auto id : world.GetDead()) {
+    RemoveSnake(id);
+  }
+
+  world.GetDead().clear();
+}
+
+template <typename T>
+static std::string Serialize(T packet) {
+  boost::asio::streambuf buf(packet.get_size());
+  std::ostream out(&buf);
+  out << packet;
+  return std::string(boost::asio::buffer_cast<const char *>(buf.data()), buf.size());
+}
+
+void Room::FlushSpectators(long now) {
+  SectorSeq *ss = &world.GetSectors();
+  const char *frames = boost::asio::buffer_cast<const char *>(spectator_frames.data());
+  // set food frames are the largest ones, serialized once per sector
+  std::unordered_map<const Sector *, std::string> food;
+
+  for (auto &i : spectators) {
+    Spectator &sp = i.second;
+    error_code ec;
+    const WSPPServer::connection_ptr con = endpoint.get_con_from_hdl(i.first, ec);
+    if (ec) {
+      continue;
+    }
+
+    if (sp.introduced) {
+      size_t begin = 0;
+      for (const size_t end : spectator_frame_ends) {
+        endpoint.send_frame(con, frames + begin, end - begin, &traffic);
+        begin = end;
+      }
+    } else {
+      Introduce(i.first);
+      sp.introduced = true;
+    }
+
+    if (sp.follow != 0) {
+      const auto snake_i = world.GetSnake(sp.follow);
+      if (snake_i != world.GetSnakes().end()) {
+        sp.x = snake_i->second->get_head_x();
+        sp.y = snake_i->second->get_head_y();
+      }
+    }
+
+    sp.vp.x = sp.x;
+    sp.vp.y = sp.y;
+    sp.vp.Update(ss, sp.x, sp.y);
+    sp.vp.CollectChanges(ss);
+
+    for (const Sector *s_ptr : sp.vp.new_sectors) {
+      endpoint.send_binary(i.first, packet_add_sector(s_ptr->x, s_ptr->y), &traffic);
+      std::string &f = food[s_ptr];
+      if (f.empty()) {
+        f = Serialize(packet_set_food(s_ptr));
+      }
+      endpoint.send_frame(con, f.data(), f.size(), &traffic);
+    }
+    sp.vp.new_sectors.clear();
+
+    for (const Sector *s_ptr : sp.vp.old_sectors) {
+      endpoint.send_binary(i.first, packet_remove_sector(s_ptr->x, s_ptr->y), &traffic);
+    }
+    sp.vp.old_sectors.clear();
+  }
+
+  spectator_frames.consume(spectator_frames.size());
+  spectator_frame_ends.clear();
+  last_spectator_time = now;
+}
+
+void Room::Introduce(connection_hdl hdl) {
+  endpoint.send_binary(hdl, init, &traffic);
+  for (auto ptr : world.GetSnakes()) {
+    const Snake *s = ptr.second.get();
+    endpoint.send_binary(hdl, packet_add_snake(s), &traffic);
+    endpoint.send_binary(hdl, packet_move(s), &traffic);
+  }
+}
+
+void Room::on_spectate(connection_hdl hdl, snake_id_t follow) {
+  spectators[hdl] = Spectator(follow);
+  Log("Spectator joined" + (follow != 0 ? ", following snake " + std::to_string(follow) : std::string()));
+}
+
+void Room::on_open(connection_hdl hdl) {
+  const auto new_snake_ptr = world.CreateSnake();
+  world.AddSnake(new_snake_ptr);
+  journal.Join(new_snake_ptr->id);
+
+  sessions[hdl] = Session(new_snake_ptr->id, GetCurrentTime());
+  connections[new_snake_ptr->id] = hdl;
+
+  const auto ses_i = sessions.find(hdl);
+  endpoint.send_binary(hdl, init, &traffic, &ses_i->second.traffic);
+
+  // send snake
+  broadcast_binary(packet_add_snake(new_snake_ptr.get()));
+  broadcast_binary(packet_move(new_snake_ptr.get()));
+  SendPOVUpdateTo(ses_i, new_snake_ptr.get());
+
+  // introduce other snakes in sectors view
+  for (auto ptr : world.GetSnakes()) {
+    if (ptr.first != new_snake_ptr->id) {
+      const Snake *s = ptr.second.get();
+      send_binary(ses_i, packet_add_snake(s));
+      send_binary(ses_i, packet_move(s));
+    }
+  }
+}
+
+void Room::on_message(connection_hdl hdl, message_ptr ptr) {
+  if (ptr->get_opcode() != opcode::binary) {
+    Log(&log_bad_opcode, ptr->get_opcode());
+    return;
+  }
+
+  const std::string &payload = ptr->get_payload();
+  const size_t len = payload.size();
+  in_packet_t packet_type = len > 0 ? static_cast<in_packet_t>(payload[0]) : in_packet_t_angle;
+
+  // len check
+  traffic.CountIn(packet_type, len);
+  if (len > 255) {
+    Log(&log_too_big, packet_type, len);
+    return;
+  }
+
+  // session obtain
+  const auto ses_i = sessions.find(hdl);
+  if (ses_i == sessions.end()) {
+    Log(&log_no_session);
+    return;
+  }
+
+  // last client time manage
+  Session &ss = ses_i->second;
+  ss.traffic.CountIn(packet_type, len);
+  journal.Packet(ss.snake_id, payload);
+
+  // parsing, snake inputs are buffered until the next tick
+  if (packet_type <= 250 && len == 1) {
+    // in_packet_t_angle, [0 - 250]
+    if (!world.InputAngle(ss.snake_id, packet_type)) {
+      Log(&log_input_flood, ss.snake_id);
+    }
+    return;
+  }
+
+  // reader of the rest
+  std::stringstream buf(payload, std::ios_base::in);
+  buf.ignore(1);
+
+  switch (packet_type) {
+    case in_packet_t_ping:
+      send_binary(ses_i, packet_pong());
+      break;
+
+    case in_packet_t_username_skin:
+      buf >> ss.protocol_version;
+      buf >> ss.skin;
+      buf.str(ss.name);
+
+      DoSnake(ss.snake_id, [&ss](Snake *s) {
+        s->name = ss.name;
+        s->skin = ss.skin;
+      });
+      break;
+
+    case in_packet_t_victory_message:
+      buf >> packet_type;  // always 118
+      buf.str(ss.message);
+      break;
+
+    case in_packet_t_rot_left:
+      buf >> packet_type;  // vfrb (virtual frames count) [0 - 127] of turning
+                           // into the right direction
+      // snake.eang -= mamu * v * snake.scang * snake.spang)
+      Log(&log_rotate_ccw, ss.snake_id, packet_type);
+      break;
+
+    case in_packet_t_rot_right:
+      buf >> packet_type;  // vfrb (virtual frames count) [0 - 127] of turning
+                           // into the right direction
+      // snake.eang += mamu * v * snake.scang * snake.spang)
+      Log(&log_rotate_cw, ss.snake_id, packet_type);
+      break;
+
+    case in_packet_t_start_acc:
+    case in_packet_t_stop_acc:
+      if (!world.InputBoost(ss.snake_id, packet_type == in_packet_t_start_acc)) {
+        Log(&log_input_flood, ss.snake_id);
+      }
+      break;
+
+    default:
+      Log(&log_bad_packet, packet_type, len);
+      break;
+  }
+}
+
+void Room::on_close(connection_hdl hdl) {
+  const auto ptr = sessions.find(hdl);
+  if (ptr != sessions.end()) {
+    const snake_id_t snakeId = ptr->second.snake_id;
+
+    std::stringstream s;
+    s << "Session snake " << snakeId << " closed, " << ptr->second.traffic;
+    Log(s.str());
+
+    sessions.erase(ptr->first);
+    RemoveSnake(snakeId);
+    journal.Leave(snakeId);
+    return;
+  }
+
+  const auto sp = spectators.find(hdl);
+  if (sp != spectators.end()) {
+    sp->second.vp.Clear(&world.GetSectors());
+    spectators.erase(sp);
+  }
+}
+
+void Room::RemoveSnake(snake_id_t id) {
+  connections.erase(id);
+  world.RemoveSnake(id);
+}
+
+PacketInit Room::BuildInitPacket() {
+  PacketInit init_packet;
+
+  init_packet.game_radius = WorldConfig::game_radius;
+  init_packet.max_snake_parts = WorldConfig::max_snake_parts;
+  init_packet.sector_size = WorldConfig::sector_size;
+  init_packet.sector_count_along_edge = WorldConfig::sector_count_along_edge;
+
+  init_packet.spangdv = Snake::spangdv;
+  init_packet.nsp1 = Snake::nsp1;
+  init_packet.nsp2 = Snake::nsp2;
+  init_packet.nsp3 = Snake::nsp3;
+
+  init_packet.snake_ang_speed = 8.0f * Snake::snake_angular_speed / 1000.0f;
+  init_packet.prey_ang_speed = 8.0f * Snake::prey_angular_speed / 1000.0f;
+  init_packet.snake_tail_k = Snake::snake_tail_k;
+
+  init_packet.protocol_version = WorldConfig::protocol_version;
+
+  return init_packet;
+}
+
+long Room::GetCurrentTime() {
+  using std::chrono::milliseconds;
+  using std::chrono::duration_cast;
+  using std::chrono::steady_clock;
+
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Room::DoSnake(snake_id_t id, std::function<void(Snake *)> f) {
+  if (id > 0) {
+    const auto snake_i = world.GetSnake(id);
+    if (snake_i->first == id) {
+      f(snake_i->second.get());
+    }
+  }
+}
+
+Room::SessionMap::iterator Room::LoadSessionIter(snake_id_t id) {
+  const auto hdl_i = connections.find(id);
+  if (hdl_i == connections.end()) {
+    Log(&log_no_connection, id);
+    return sessions.end();
+  }
+
+  const auto ses_i = sessions.find(hdl_i->second);
+  if (ses_i == sessions.end()) {
+    Log(&log_no_snake_session, id);
+  }
+
+  return ses_i;
+}
@@ -0,0 +1,217 @@
+#ifndef SRC_SERVER_ROOM_H_
+#define SRC_SERVER_ROOM_H_
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/streambuf.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server/async_log.h"
+#include "server/metrics.h"
+#include "server/profiler.h"
+#include "server/server.h"
+#include "server/traffic.h"
+
+#include "game/journal.h"
+#include "game/world.h"
+
+#include "packet/d_all.h"
+#include "packet/p_all.h"
+
+struct Session {
+  snake_id_t snake_id = 0;
+  long last_packet_time = 0;
+
+  std::string name;
+  std::string message;
+
+  uint8_t protocol_version = 0;  // current 8
+  uint8_t skin = 0;              // 0 - 39
+
+  TrafficStats traffic;         // since connect
+  uint64_t last_out_bytes = 0;  // at the last stats print
+
+  Session() = default;
+  Session(snake_id_t id, long now) : snake_id(id), last_packet_time(now) {}
+};
+
+// Connection watching the game without a snake. The view floats where it was
+// put or follows a snake, and is introduced to the world at its first flush.
+struct Spectator {
+  snake_id_t follow = 0;  // 0 - free view
+  float x = WorldConfig::game_radius;
+  float y = WorldConfig::game_radius;
+  bool introduced = false;
+  ViewPort vp;
+
+  Spectator() : Spectator(0) {}
+  explicit Spectator(snake_id_t in_follow) : follow(in_follow) {
+    vp.r = ViewPort::view_radius;
+    vp.count = &Sector::spectators;
+  }
+};
+
+// Independent game: a world, its player sessions and the game loop. Every room
+// runs on its own thread with its own io_service. The listener posts
+// connection events of the room players there, so the room state is only ever
+// touched by the room thread. Frames are sent through the shared endpoint,
+// which is thread safe.
+class Room {
+ public:
+  Room(WSPPServer *server, AsyncLog *in_log, uint16_t in_room_id);
+
+  // init the world and start the room thread
+  void Start(const IncomingConfig &in_config);
+  // stop the game loop and join the room thread
+  void Stop();
+
+  // listener side, events are queued to the room thread
+  void Open(connection_hdl hdl);
+  void Message(connection_hdl hdl, message_ptr ptr);
+  void Close(connection_hdl hdl);
+  // follow is a snake id, 0 for a free view at the map center
+  void Spectate(connection_hdl hdl, snake_id_t follow);
+  // counts a spectator turned away over max_spectators
+  void RejectSpectator();
+
+  uint16_t GetId() const;
+  const ServerMetrics &GetMetrics() const;
+
+  static PacketInit BuildInitPacket();
+
+  typedef std::unordered_map<snake_id_t, connection_hdl> ConnectionMap;
+  typedef std::map<connection_hdl, Session, std::owner_less<connection_hdl>> SessionMap;
+  typedef SessionMap::iterator SessionIter;
+  typedef std::map<connection_hdl, Spectator, std::owner_less<connection_hdl>> SpectatorMap;
+
+ private:
+  void on_open(connection_hdl hdl);
+  void on_message(connection_hdl hdl, message_ptr ptr);
+  void on_close(connection_hdl hdl);
+  void on_spectate(connection_hdl hdl, snake_id_t follow);
+  void on_timer(const boost::system::error_code &ec);
+
+  void SendPOVUpdateTo(SessionIter ses_i, Snake *ptr);
+  void SendFoodUpdate(Snake *ptr);
+  void BroadcastDebug();
+  void BroadcastUpdates();
+  SessionIter LoadSessionIter(snake_id_t id);
+
+  void DoSnake(snake_id_t id, std::function<void(Snake *)> f);
+  void RemoveSnake(snake_id_t id);
+  void RemoveDeadSnakes();
+  // sends the frames since the last flush and the view changes to spectators
+  void FlushSpectators(long now);
+  void Introduce(connection_hdl hdl);
+
+  long GetCurrentTime();
+  void NextTick(long last);
+
+  // from the snapshot if there is one, true if restored
+  bool InitWorld();
+  void SaveSnapshot();
+
+  // through the async log, drops are counted to the metrics
+  void Log(const std::string &message);
+  void Log(LogSite *site, long long a = 0, long long b = 0, long long c = 0);
+  void PrintWorldInfo();
+  void PrintStats(long interval);
+  void PrintTraffic(long interval);
+  void PublishMetrics(long interval);
+
+ private:
+  template <typename T>
+  void send_binary(SessionMap::iterator s, T packet) {
+    const long now = GetCurrentTime();
+    const uint16_t interval =
+        static_cast<uint16_t>(now - s->second.last_packet_time);
+    s->second.last_packet_time = now;
+    packet.client_time = interval;
+    endpoint.send_binary(s->first, packet, &traffic, &s->second.traffic);
+  }
+
+  template <typename T>
+  void broadcast_binary(T packet) {
+    const long now = GetCurrentTime();
+    for (auto &s : sessions) {
+      const uint16_t interval =
+          static_cast<uint16_t>(now - s.second.last_packet_time);
+      s.second.last_packet_time = now;
+      packet.client_time = interval;
+      endpoint.send_binary(s.first, packet, &traffic, &s.second.traffic);
+    }
+
+    if (!spectators.empty()) {
+      AddSpectatorFrame(packet);
+    }
+  }
+
+  // serialized once for all the spectators, client time of the first frame
+  // is since the last flush
+  template <typename T>
+  void AddSpectatorFrame(T packet) {
+    packet.client_time =
+        spectator_frame_ends.empty() ? static_cast<uint16_t>(GetCurrentTime() - last_spectator_time) : 0;
+    std::ostream out(&spectator_frames);
+    out << packet;
+    spectator_frame_ends.push_back(spectator_frames.size());
+  }
+
+  template <typename T>
+  void broadcast_debug(T packet) {
+    for (auto &s : sessions) {
+      endpoint.send_binary(s.first, packet, &traffic, &s.second.traffic);
+    }
+  }
+
+  WSPPServer &endpoint;
+  AsyncLog &log;
+  const uint16_t room_id;
+
+  boost::asio::io_service service;
+  std::unique_ptr<boost::asio::io_service::work> work;
+  std::thread thread;
+
+  boost::asio::steady_timer timer;
+  long last_time_point = 0;
+  static const long timer_interval_ms = 10;
+
+  long last_stats_time = 0;
+  static const long stats_interval_ms = 10000;
+
+  long last_snapshot_time = 0;
+
+  TickProfiler profiler;
+  uint64_t next_wake_ns = 0;  // when the timer is scheduled to fire
+
+  ServerMetrics metrics;
+  long last_metrics_time = 0;
+  uint64_t last_out_bytes = 0;
+  uint64_t last_out_frames = 0;
+  static const long metrics_interval_ms = 1000;
+
+  TrafficStats traffic;       // room players, in and out
+  TrafficStats last_traffic;  // at the last stats print
+
+  World world;
+  JournalWriter journal;
+  PacketInit init;
+  IncomingConfig config;
+
+  // TODO(john.koepi): reserve to collections
+  SessionMap sessions;
+  ConnectionMap connections;
+
+  SpectatorMap spectators;
+  boost::asio::streambuf spectator_frames;
+  std::vector<size_t> spectator_frame_ends;
+  long last_spectator_time = 0;
+  static const long spectator_interval_ms = 50;
+};
+
+#endif  // SRC_SERVER_ROOM_H_
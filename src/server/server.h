@@ -5,6 +5,7 @@
 
 #include "server/config.h"
 #include "server/streambuf_array.h"
+#include "server/traffic.h"
 
 typedef websocketpp::connection_hdl connection_hdl;
 typedef websocketpp::frame::opcode::value opcode;
@@ -12,8 +13,11 @@ typedef websocketpp::lib::error_code error_code;
 
 class WSPPServer : public websocketpp::server<WSPPServerConfig> {
  public:
+  // sent frames are counted by packet type to the given stats, which are
+  // owned by the calling thread
   template <typename T>
-  void send(connection_hdl hdl, T packet, opcode op, error_code &ec) {  // NOLINT(runtime/references)
+  void send(connection_hdl hdl, T packet, opcode op, error_code &ec,  // NOLINT(runtime/references)
+            TrafficStats *total = nullptr, TrafficStats *session = nullptr) {
     const connection_ptr con = get_con_from_hdl(hdl, ec);
     if (ec) {
       return;
@@ -25,6 +29,7 @@ class WSPPServer : public websocketpp::server<WSPPServerConfig> {
       std::ostream out(&buf);
       out << packet;
       ec = con->send(boost::asio::buffer_cast<void const *>(buf.data()), buf.size(), op);
+      CountSent(buf, ec, total, session);
     } else {
       boost::asio::streambuf buf(max);
       buf.prepare(max);
@@ -33,22 +38,50 @@ class WSPPServer : public websocketpp::server<WSPPServerConfig> {
       out << packet;
 
       ec = con->send(boost::asio::buffer_cast<void const *>(buf.data()), buf.size(), op);
+      CountSent(buf, ec, total, session);
     }
   }
 
   template <typename T>
-  void send_binary(connection_hdl hdl, T packet, error_code &ec) {  // NOLINT(runtime/references)
-    send(hdl, packet, opcode::binary, ec);
+  void send_binary(connection_hdl hdl, T packet, error_code &ec,  // NOLINT(runtime/references)
+                   TrafficStats *total = nullptr, TrafficStats *session = nullptr) {
+    send(hdl, packet, opcode::binary, ec, total, session);
+  }
+
+  // an already serialized packet, the same bytes can go to many connections
+  void send_frame(const connection_ptr &con, const char *data, size_t size, TrafficStats *total) {
+    const error_code ec = con->send(data, size, opcode::binary);
+    if (!ec && total != nullptr) {
+      total->CountOut(size > 2 ? static_cast<uint8_t>(data[2]) : 0, size);
+    }
   }
 
   template <typename T>
-  void send_binary(connection_hdl hdl, T packet) {
+  void send_binary(connection_hdl hdl, T packet, TrafficStats *total = nullptr, TrafficStats *session = nullptr) {
     error_code ec;
-    send_binary(hdl, packet, ec);
+    send_binary(hdl, packet, ec, total, session);
     if (ec) {
       get_alog().write(alevel::app, "Write Error: " + ec.message());
     }
   }
+
+ private:
+  template <typename B>
+  void CountSent(const B &buf, const error_code &ec, TrafficStats *total, TrafficStats *session) {
+    if (ec) {
+      return;
+    }
+
+    // type from the wire, not every packet sets PacketBase::packet_type
+    const size_t size = buf.size();
+    const uint8_t type = size > 2 ? boost::asio::buffer_cast<const uint8_t *>(buf.data())[2] : 0;
+    if (total != nullptr) {
+      total->CountOut(type, size);
+    }
+    if (session != nullptr) {
+      session->CountOut(type, size);
+    }
+  }
 };
 
 typedef WSPPServer::message_ptr message_ptr;
@@ -2,6 +2,7 @@
 #define SRC_SERVER_STREAMBUF_ARRAY_H_
 
 #include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
 
 #include <array>
 #include <algorithm>
@@ -0,0 +1,244 @@
+#include "server/supervisor.h"
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "server/game.h"
+
+static volatile sig_atomic_t stop_signal = 0;
+
+static volatile sig_atomic_t reload_signal = 0;
+
+static void OnStopSignal(int sig) { stop_signal = sig; }
+static void OnReloadSignal(int) { reload_signal = 1; }
+
+Supervisor::Supervisor(const IncomingConfig &in_config) : config(in_config), workers(in_config.workers) {}
+
+int Supervisor::Run() {
+  // workers differ, but each one is reproducible from the logged seed
+  if (config.world.seed == 0) {
+    config.world.seed = static_cast<uint32_t>(std::time(nullptr));
+  }
+
+  signal(SIGINT, OnStopSignal);
+  signal(SIGTERM, OnStopSignal);
+  signal(SIGHUP, OnReloadSignal);
+
+  std::cout << "Supervisor " << getpid() << ", " << workers.size() << " workers on port " << config.port
+            << std::endl;
+
+  for (size_t i = 0; i < workers.size(); i++) {
+    if (!Spawn(i)) {
+      Shutdown();
+      return 1;
+    }
+  }
+
+  while (stop_signal == 0) {
+    Serve(100);
+    Reap();
+
+    if (reload_signal != 0) {
+      reload_signal = 0;
+      Reload();
+    }
+
+    const long now = GetCurrentTime();
+    for (size_t i = 0; i < workers.size(); i++) {
+      if (workers[i].pid == 0 && now >= workers[i].restart_at) {
+        Spawn(i);
+      }
+    }
+  }
+
+  std::cout << "Supervisor stopping on signal " << stop_signal << std::endl;
+  Shutdown();
+  return 0;
+}
+
+bool Supervisor::Spawn(size_t slot) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) != 0) {
+    std::cerr << "Failed to create control socket: " << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  const pid_t pid = fork();
+  if (pid < 0) {
+    std::cerr << "Failed to fork worker " << slot << ": " << std::strerror(errno) << std::endl;
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+
+  if (pid == 0) {
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    // until the game server takes it over, a reload must not kill the worker
+    signal(SIGHUP, SIG_IGN);
+
+    close(fds[0]);
+    for (const Worker &w : workers) {
+      if (w.fd >= 0) {
+        close(w.fd);
+      }
+    }
+
+    IncomingConfig worker_config = config;
+    worker_config.workers = 0;
+    worker_config.reuse_port = true;
+    worker_config.control_fd = fds[1];
+    // room seeds of a worker are seed + room id
+    worker_config.world.seed = config.world.seed + static_cast<uint32_t>(slot) * 65536;
+    if (!config.journal_file.empty()) {
+      worker_config.journal_file += ".w" + std::to_string(slot);
+    }
+    if (!config.snapshot_file.empty()) {
+      worker_config.snapshot_file += ".w" + std::to_string(slot);
+    }
+
+    const int code = std::unique_ptr<GameServer>(new GameServer())->Run(worker_config);
+    std::cout.flush();
+    _exit(code);
+  }
+
+  close(fds[1]);
+
+  Worker &w = workers[slot];
+  w.pid = pid;
+  w.fd = fds[0];
+  w.started = GetCurrentTime();
+  w.report = ControlReport();
+
+  std::cout << "Worker " << slot << " started, pid " << pid << std::endl;
+  return true;
+}
+
+void Supervisor::Reap() {
+  int status = 0;
+  pid_t pid;
+
+  while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+    for (size_t i = 0; i < workers.size(); i++) {
+      Worker &w = workers[i];
+      if (w.pid != pid) {
+        continue;
+      }
+
+      const long now = GetCurrentTime();
+      if (now - w.started < min_uptime_ms) {
+        w.backoff = w.backoff == 0 ? 1000 : w.backoff * 2;
+        if (w.backoff > max_backoff_ms) {
+          w.backoff = max_backoff_ms;
+        }
+      } else {
+        w.backoff = 0;
+      }
+      w.restart_at = now + w.backoff;
+
+      close(w.fd);
+      w.fd = -1;
+      w.pid = 0;
+      w.report = ControlReport();
+
+      std::cout << "Worker " << i << " pid " << pid;
+      if (WIFSIGNALED(status)) {
+        std::cout << " killed by signal " << WTERMSIG(status);
+      } else {
+        std::cout << " exited with " << WEXITSTATUS(status);
+      }
+      std::cout << ", restart in " << w.backoff << "ms" << std::endl;
+    }
+  }
+}
+
+void Supervisor::Serve(int timeout_ms) {
+  std::vector<pollfd> fds;
+  std::vector<size_t> slots;
+  for (size_t i = 0; i < workers.size(); i++) {
+    if (workers[i].fd >= 0) {
+      fds.push_back(pollfd{workers[i].fd, POLLIN, 0});
+      slots.push_back(i);
+    }
+  }
+
+  if (poll(fds.data(), fds.size(), timeout_ms) <= 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < fds.size(); i++) {
+    if (!(fds[i].revents & POLLIN)) {
+      continue;
+    }
+
+    Worker &w = workers[slots[i]];
+    ControlReport report;
+    if (recv(w.fd, &report, sizeof(report), MSG_DONTWAIT) == sizeof(report)) {
+      w.report = report;
+
+      const ControlState state = GetState();
+      send(w.fd, &state, sizeof(state), MSG_DONTWAIT);
+    }
+  }
+}
+
+void Supervisor::Reload() {
+  size_t n = 0;
+  for (const Worker &w : workers) {
+    if (w.pid > 0 && kill(w.pid, SIGHUP) == 0) {
+      n++;
+    }
+  }
+  std::cout << "Supervisor reloading " << n << " workers" << std::endl;
+}
+
+void Supervisor::Shutdown() {
+  for (const Worker &w : workers) {
+    if (w.pid > 0) {
+      kill(w.pid, SIGTERM);
+    }
+  }
+
+  for (Worker &w : workers) {
+    if (w.pid > 0) {
+      waitpid(w.pid, nullptr, 0);
+      w.pid = 0;
+    }
+    if (w.fd >= 0) {
+      close(w.fd);
+      w.fd = -1;
+    }
+  }
+}
+
+ControlState Supervisor::GetState() const {
+  ControlState state;
+  for (const Worker &w : workers) {
+    if (w.pid > 0) {
+      state.players += w.report.players;
+      state.capacity += w.report.capacity;
+      state.workers++;
+    }
+  }
+  return state;
+}
+
+long Supervisor::GetCurrentTime() const {
+  using std::chrono::milliseconds;
+  using std::chrono::duration_cast;
+  using std::chrono::steady_clock;
+
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
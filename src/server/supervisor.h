@@ -0,0 +1,50 @@
+#ifndef SRC_SERVER_SUPERVISOR_H_
+#define SRC_SERVER_SUPERVISOR_H_
+
+#include <sys/types.h>
+
+#include <vector>
+
+#include "server/config.h"
+#include "server/control.h"
+
+// Forks the worker processes, each a whole GameServer listening on the same
+// port with SO_REUSEPORT, so the kernel spreads connections between them.
+// Workers share nothing, a crash takes out only the players of that worker.
+// The supervisor restarts dead workers, with a growing delay for the ones
+// dying right after start, and aggregates worker load reports so workers can
+// turn away players above their fair share. SIGHUP is forwarded to the live
+// workers, each reloads its TLS certificate.
+class Supervisor {
+ public:
+  explicit Supervisor(const IncomingConfig &in_config);
+
+  int Run();
+
+ private:
+  struct Worker {
+    pid_t pid = 0;
+    int fd = -1;  // supervisor end of the control socket pair
+    long started = 0;
+    long restart_at = 0;
+    long backoff = 0;
+    ControlReport report;
+  };
+
+  bool Spawn(size_t slot);
+  void Reap();
+  void Serve(int timeout_ms);
+  void Reload();
+  void Shutdown();
+
+  ControlState GetState() const;
+  long GetCurrentTime() const;
+
+  IncomingConfig config;
+  std::vector<Worker> workers;
+
+  static const long min_uptime_ms = 5000;  // died sooner - back off restarts
+  static const long max_backoff_ms = 30000;
+};
+
+#endif  // SRC_SERVER_SUPERVISOR_H_
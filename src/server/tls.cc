@@ -0,0 +1,65 @@
+#include "server/tls.h"
+
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+static const unsigned char session_id_context[] = "slither";
+static const long session_cache_size = 1 << 15;  // sessions
+static const long session_timeout = 3600;        // s
+
+std::string LoadTicketKeys(const std::string &file) {
+  std::string keys(tls_ticket_keys_size, '\0');
+  if (file.empty()) {
+    if (RAND_bytes(reinterpret_cast<unsigned char *>(&keys[0]), static_cast<int>(keys.size())) != 1) {
+      throw std::runtime_error("failed to generate TLS ticket keys");
+    }
+    return keys;
+  }
+
+  std::ifstream in(file, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("failed to open TLS ticket key file " + file);
+  }
+
+  keys.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  if (keys.size() != tls_ticket_keys_size) {
+    throw std::runtime_error("TLS ticket key file " + file + " must be " + std::to_string(tls_ticket_keys_size) +
+                             " bytes");
+  }
+  return keys;
+}
+
+TlsContextPtr CreateTlsContext(const std::string &cert_file, const std::string &key_file,
+                               const std::string &ticket_keys) {
+  namespace asio = boost::asio;
+
+  auto ctx = std::make_shared<asio::ssl::context>(asio::ssl::context::tlsv12);
+
+  ctx->set_options(asio::ssl::context::default_workarounds |
+                   asio::ssl::context::no_sslv2 |
+                   asio::ssl::context::no_sslv3 |
+                   asio::ssl::context::single_dh_use);
+
+  ctx->use_certificate_chain_file(cert_file);
+  ctx->use_private_key_file(key_file, asio::ssl::context::pem);
+
+  // the session cache is per context, tickets resume on any worker and context
+  SSL_CTX *const native = ctx->native_handle();
+  SSL_CTX_clear_options(native, SSL_OP_NO_TICKET);
+  SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_sess_set_cache_size(native, session_cache_size);
+  SSL_CTX_set_timeout(native, session_timeout);
+  SSL_CTX_set_session_id_context(native, session_id_context, sizeof(session_id_context) - 1);
+
+  std::string keys = ticket_keys;
+  if (keys.size() != tls_ticket_keys_size ||
+      SSL_CTX_set_tlsext_ticket_keys(native, &keys[0], static_cast<long>(keys.size())) != 1) {
+    throw std::runtime_error("failed to set TLS ticket keys");
+  }
+
+  return ctx;
+}
@@ -0,0 +1,28 @@
+#ifndef SRC_SERVER_TLS_H_
+#define SRC_SERVER_TLS_H_
+
+#include <boost/asio/ssl/context.hpp>
+
+#include <memory>
+#include <string>
+
+typedef std::shared_ptr<boost::asio::ssl::context> TlsContextPtr;
+
+// session ticket key name, HMAC and AES keys, as OpenSSL 1.1+ takes them
+static const size_t tls_ticket_keys_size = 80;  // bytes
+
+// Session ticket keys read from a file of exactly tls_ticket_keys_size bytes,
+// or random ones if file is empty. All the processes serving the port must
+// share them, or a client resumes only on the one that issued its ticket.
+// Throws std::exception if the file does not load.
+std::string LoadTicketKeys(const std::string &file);
+
+// Server context shared by all the connections: the certificate chain and
+// key are parsed once, the session cache and tickets let returning clients
+// resume without the full handshake. Tickets are encrypted with ticket_keys,
+// so they stay valid across reloads. Throws std::exception if the files do
+// not load.
+TlsContextPtr CreateTlsContext(const std::string &cert_file, const std::string &key_file,
+                               const std::string &ticket_keys);
+
+#endif  // SRC_SERVER_TLS_H_
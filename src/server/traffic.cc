@@ -0,0 +1,99 @@
+#include "server/traffic.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "packet/p_base.h"
+
+// slot 0 is other, slot i + 1 is out_types[i]
+static const char out_types[] = "aE3e45hrgGnNlvWwmpusFbfcjyk0!";
+static_assert(sizeof(out_types) == TrafficStats::out_slots, "out slots mismatch");
+
+static const char *const in_names[] = {
+    "other", "angle", "ping", "rot_left", "rot_right", "start_acc", "stop_acc", "username_skin", "victory_message"};
+static_assert(sizeof(in_names) / sizeof(in_names[0]) == TrafficStats::in_slots, "in slots mismatch");
+
+uint8_t TrafficStats::GetOutSlot(uint8_t type) {
+  const void *p = std::memchr(out_types, type, out_slots - 1);
+  return p == nullptr ? 0 : static_cast<uint8_t>(static_cast<const char *>(p) - out_types + 1);
+}
+
+uint8_t TrafficStats::GetInSlot(uint8_t type, size_t size) {
+  // the same rule as GameServer::on_message
+  if (type <= 250 && size == 1) {
+    return 1;
+  }
+
+  switch (type) {
+    case in_packet_t_ping:
+      return 2;
+    case in_packet_t_rot_left:
+      return 3;
+    case in_packet_t_rot_right:
+      return 4;
+    case in_packet_t_start_acc:
+      return 5;
+    case in_packet_t_stop_acc:
+      return 6;
+    case in_packet_t_username_skin:
+      return 7;
+    case in_packet_t_victory_message:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+std::string TrafficStats::GetOutName(uint8_t slot) {
+  return slot == 0 ? "other" : std::string(1, out_types[slot - 1]);
+}
+
+const char *TrafficStats::GetInName(uint8_t slot) { return in_names[slot]; }
+
+static void Subtract(PacketCounter *c, const PacketCounter &before) {
+  c->frames -= before.frames;
+  c->bytes -= before.bytes;
+}
+
+TrafficStats TrafficStats::Since(const TrafficStats &before) const {
+  TrafficStats result = *this;
+  for (uint8_t i = 0; i < out_slots; i++) {
+    Subtract(&result.out[i], before.out[i]);
+  }
+  for (uint8_t i = 0; i < in_slots; i++) {
+    Subtract(&result.in[i], before.in[i]);
+  }
+  Subtract(&result.out_total, before.out_total);
+  Subtract(&result.in_total, before.in_total);
+  return result;
+}
+
+template <typename C, typename N>
+static void PrintSlots(std::ostream &out, const PacketCounter &total, uint8_t count, C counter, N name) {
+  std::vector<uint8_t> order;
+  for (uint8_t i = 0; i < count; i++) {
+    if (counter(i).frames > 0) {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [&counter](uint8_t a, uint8_t b) { return counter(a).bytes > counter(b).bytes; });
+
+  out << total.frames << " frames, " << total.bytes << " bytes";
+  for (uint8_t i : order) {
+    const PacketCounter &c = counter(i);
+    out << ", " << name(i) << " " << c.frames << "/" << c.bytes
+        << " (" << c.bytes * 100 / std::max<uint64_t>(1, total.bytes) << "%)";
+  }
+}
+
+std::ostream &operator<<(std::ostream &out, const TrafficStats &t) {
+  out << "out ";
+  PrintSlots(out, t.GetOutTotal(), TrafficStats::out_slots,
+             [&t](uint8_t i) -> const PacketCounter & { return t.GetOut(i); }, TrafficStats::GetOutName);
+  out << "; in ";
+  PrintSlots(out, t.GetInTotal(), TrafficStats::in_slots,
+             [&t](uint8_t i) -> const PacketCounter & { return t.GetIn(i); }, TrafficStats::GetInName);
+  return out;
+}
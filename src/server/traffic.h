@@ -0,0 +1,61 @@
+#ifndef SRC_SERVER_TRAFFIC_H_
+#define SRC_SERVER_TRAFFIC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+struct PacketCounter {
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+
+  void Add(size_t size) {
+    frames++;
+    bytes += size;
+  }
+};
+
+// Frames and bytes by packet type. Outbound packets are keyed by the
+// out_packet_t byte on the wire, so rotation variants sharing a type byte are
+// counted together. Inbound by in_packet_t, angle covers all the one byte
+// 0 - 250 packets. Types map to dense slots to keep a copy per session small.
+class TrafficStats {
+ public:
+  static const uint8_t out_slots = 30;  // known types + other
+  static const uint8_t in_slots = 9;    // known types + other
+
+  static uint8_t GetOutSlot(uint8_t type);
+  static uint8_t GetInSlot(uint8_t type, size_t size);
+  static std::string GetOutName(uint8_t slot);
+  static const char *GetInName(uint8_t slot);
+
+  void CountOut(uint8_t type, size_t size) {
+    out[GetOutSlot(type)].Add(size);
+    out_total.Add(size);
+  }
+
+  void CountIn(uint8_t type, size_t size) {
+    in[GetInSlot(type, size)].Add(size);
+    in_total.Add(size);
+  }
+
+  const PacketCounter &GetOut(uint8_t slot) const { return out[slot]; }
+  const PacketCounter &GetIn(uint8_t slot) const { return in[slot]; }
+  const PacketCounter &GetOutTotal() const { return out_total; }
+  const PacketCounter &GetInTotal() const { return in_total; }
+
+  // counters accumulated after the before snapshot was taken
+  TrafficStats Since(const TrafficStats &before) const;
+
+ private:
+  PacketCounter out[out_slots];
+  PacketCounter in[in_slots];
+  PacketCounter out_total;
+  PacketCounter in_total;
+};
+
+// totals and non zero types, heaviest first
+std::ostream &operator<<(std::ostream &out, const TrafficStats &t);
+
+#endif  // SRC_SERVER_TRAFFIC_H_